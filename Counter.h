@@ -0,0 +1,68 @@
+/*-----------------------------------------------------------/
+/ Counter.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+namespace FlashParamNs {
+//=================================
+// Interface of Counter class
+//=================================
+// monotonic counter encoded as a base value and a unary field of N bytes (see Parameter<Counter<N>>)
+//   each increment clears the next bit of the field, which NOR flash can program without erase,
+//   and the field is compacted into the base value only when all of its bits are cleared
+template <size_t N>
+class Counter
+{
+public:
+    static_assert(N > 0 && N % sizeof(uint32_t) == 0, "N must be a multiple of 4");
+    static constexpr uint32_t Capacity = N * 8;  // increments until compaction
+    Counter() = default;
+    Counter(const uint32_t& value) : base(value) {}
+    uint32_t value() const {
+        uint32_t count = 0;
+        for (const auto& mark : marks) {
+            if (mark != 0) {
+                return base + count + _trailingZeros(mark);
+            }
+            count += 8;
+        }
+        return base + count;
+    }
+    // returns false if the field was exhausted and compacted (needs erase to store on flash)
+    bool increment() {
+        for (auto& mark : marks) {
+            if (mark != 0) {
+                mark &= mark - 1;  // clear the lowest set bit
+                return true;
+            }
+        }
+        *this = Counter(base + Capacity + 1);
+        return false;
+    }
+    uint32_t getLeft() const { return Capacity - (value() - base); }  // increments left until compaction
+    bool operator==(const Counter& other) const { return base == other.base && marks == other.marks; }
+    bool operator!=(const Counter& other) const { return !(*this == other); }
+
+private:
+    static constexpr std::array<uint8_t, N> _blank() {
+        std::array<uint8_t, N> blank = {};
+        for (auto& mark : blank) { mark = 0xff; }
+        return blank;
+    }
+    static uint32_t _trailingZeros(uint8_t mark) {
+        uint32_t n = 0;
+        while ((mark & 1) == 0) { mark >>= 1; n++; }
+        return n;
+    }
+    uint32_t base = 0;
+    std::array<uint8_t, N> marks = _blank();  // cleared from the lowest bit of the first byte
+};
+}
@@ -0,0 +1,74 @@
+/*-----------------------------------------------------------/
+/ Crc32.cpp
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#include "Crc32.h"
+
+#include <array>
+#include <cstring>
+
+namespace FlashParamNs {
+namespace {
+constexpr uint32_t Polynomial = 0xedb88320UL;  // reflected 0x04c11db7
+using table_t = std::array<std::array<uint32_t, 256>, 4>;
+
+// Table[0] is for a byte, Table[k] is for a byte followed by k zero bytes
+constexpr table_t _makeTable()
+{
+    table_t table = {};
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t crc = i;
+        for (int bit = 0; bit < 8; bit++) {
+            crc = (crc & 1) ? (crc >> 1) ^ Polynomial : crc >> 1;
+        }
+        table[0][i] = crc;
+    }
+    for (uint32_t i = 0; i < 256; i++) {
+        for (size_t k = 1; k < table.size(); k++) {
+            table[k][i] = (table[k - 1][i] >> 8) ^ table[0][table[k - 1][i] & 0xff];
+        }
+    }
+    return table;
+}
+constexpr table_t Table = _makeTable();  // 4 KB on flash (rodata)
+}
+
+//=================================
+// Implementation of Crc32 class
+//=================================
+Crc32::kernel_t Crc32::kernel = Crc32::calcSliceBy4;
+
+void Crc32::setKernel(kernel_t func)
+{
+    kernel = (func != nullptr) ? func : calcSliceBy4;
+}
+
+uint32_t Crc32::calcBytewise(const uint8_t* data, const size_t& size)
+{
+    uint32_t crc = 0xffffffffUL;
+    for (size_t i = 0; i < size; i++) {
+        crc = Table[0][(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+uint32_t Crc32::calcSliceBy4(const uint8_t* data, const size_t& size)
+{
+    uint32_t crc = 0xffffffffUL;
+    size_t i = 0;
+    for (; i + sizeof(uint32_t) <= size; i += sizeof(uint32_t)) {
+        uint32_t word;
+        std::memcpy(&word, data + i, sizeof(word));  // little endian (both RP2040/RP2350 and usual hosts)
+        crc ^= word;
+        crc = Table[3][crc & 0xff] ^ Table[2][(crc >> 8) & 0xff] ^ Table[1][(crc >> 16) & 0xff] ^ Table[0][crc >> 24];
+    }
+    for (; i < size; i++) {
+        crc = Table[0][(crc ^ data[i]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+}
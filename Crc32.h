@@ -0,0 +1,31 @@
+/*-----------------------------------------------------------/
+/ Crc32.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace FlashParamNs {
+//=================================
+// Interface of Crc32 class
+//=================================
+// CRC-32 (IEEE 802.3 polynomial, reflected, init and xorout 0xffffffff: same as zlib crc32())
+class Crc32
+{
+public:
+    using kernel_t = uint32_t (*)(const uint8_t* data, const size_t& size);
+    static uint32_t calc(const uint8_t* data, const size_t& size) { return kernel(data, size); }
+    // replace the kernel (e.g. DMA sniffer on target). nullptr restores the default kernel
+    static void setKernel(kernel_t func);
+    static uint32_t calcBytewise(const uint8_t* data, const size_t& size);  // a table lookup per byte
+    static uint32_t calcSliceBy4(const uint8_t* data, const size_t& size);  // 4 table lookups per 32-bit word (default)
+private:
+    static kernel_t kernel;
+};
+}
@@ -0,0 +1,197 @@
+/*-----------------------------------------------------------/
+/ EmuFlashBackend.cpp
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#include "EmuFlashBackend.h"
+
+#include <algorithm>
+#include <chrono>
+#include <thread>
+
+namespace FlashParamNs {
+FlashBackend& FlashBackend::instance()
+{
+    return EmuFlashBackend::instance();
+}
+
+//=================================
+// Implementation of EmuFlashBackend class
+//=================================
+EmuFlashBackend& EmuFlashBackend::instance()
+{
+    static EmuFlashBackend instance; // Singleton
+    return instance;
+}
+
+EmuFlashBackend::EmuFlashBackend() : mem(PICO_FLASH_SIZE_BYTES, 0xff)
+{
+}
+
+EmuFlashBackend::~EmuFlashBackend()
+{
+    close();
+}
+
+const uint8_t* EmuFlashBackend::getReadAddr(const uint32_t& flash_ofs) const
+{
+    return mem.data() + flash_ofs;
+}
+
+void EmuFlashBackend::erase(const uint32_t& flash_ofs, const size_t& size)
+{
+    if (flash_ofs % FLASH_SECTOR_SIZE != 0 || size % FLASH_SECTOR_SIZE != 0 || flash_ofs + size > mem.size()) {
+        printf("EmuFlashBackend: illegal erase 0x%x (0x%x)\r\n", static_cast<int>(flash_ofs), static_cast<int>(size));
+        violationCount++;
+        return;
+    }
+    const size_t n = _powerBudget(size);
+    if (sectorEraseDelayUsec > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(sectorEraseDelayUsec * (size / FLASH_SECTOR_SIZE)));
+    }
+    std::fill(mem.begin() + flash_ofs, mem.begin() + flash_ofs + n, 0xff);
+    eraseCount += size / FLASH_SECTOR_SIZE;
+    eraseBytes += size;
+    _writeThrough(flash_ofs, size);
+}
+
+void EmuFlashBackend::program(const uint32_t& flash_ofs, const uint8_t* data, const size_t& size)
+{
+    if (flash_ofs % FLASH_PAGE_SIZE != 0 || size % FLASH_PAGE_SIZE != 0 || flash_ofs + size > mem.size()) {
+        printf("EmuFlashBackend: illegal program 0x%x (0x%x)\r\n", static_cast<int>(flash_ofs), static_cast<int>(size));
+        violationCount++;
+        return;
+    }
+    const size_t n = _powerBudget(size);
+    if (pageProgramDelayUsec > 0) {
+        std::this_thread::sleep_for(std::chrono::microseconds(pageProgramDelayUsec * (size / FLASH_PAGE_SIZE)));
+    }
+    for (size_t i = 0; i < n; i++) {
+        auto& cell = mem.at(flash_ofs + i);
+        if (data[i] & ~cell) {  // 0 -> 1 is not programmable without erase
+            violationCount++;
+        }
+        cell &= data[i];
+    }
+    programCount += size / FLASH_PAGE_SIZE;
+    programBytes += size;
+    _writeThrough(flash_ofs, size);
+}
+
+bool EmuFlashBackend::safeExecute(void (*func)(void*), void* param, const uint32_t& /* timeout_ms */)
+{
+    if (safeExecuteFailure) { return false; }
+    // emulate the other core paused by flash_safe_execute()
+    std::lock_guard<std::mutex> guard(mtx);
+    func(param);
+    return true;
+}
+
+uint64_t EmuFlashBackend::getTimeUs() const
+{
+    const auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+bool EmuFlashBackend::open(const char* path)
+{
+    close();
+    fp = fopen(path, "r+b");
+    if (fp != nullptr) {
+        const auto n = fread(mem.data(), 1, mem.size(), fp);
+        std::fill(mem.begin() + n, mem.end(), 0xff);
+        return true;
+    }
+    // create new file as blank flash
+    fp = fopen(path, "w+b");
+    if (fp == nullptr) {
+        return false;
+    }
+    blank();
+    return true;
+}
+
+void EmuFlashBackend::close()
+{
+    if (fp != nullptr) {
+        fclose(fp);
+        fp = nullptr;
+    }
+}
+
+void EmuFlashBackend::blank()
+{
+    std::fill(mem.begin(), mem.end(), 0xff);
+    _writeThrough(0, mem.size());
+}
+
+void EmuFlashBackend::resetCounters()
+{
+    eraseCount = 0;
+    eraseBytes = 0;
+    programCount = 0;
+    programBytes = 0;
+    violationCount = 0;
+}
+
+void EmuFlashBackend::setDelay(const uint32_t& sectorEraseUsec, const uint32_t& pageProgramUsec)
+{
+    sectorEraseDelayUsec = sectorEraseUsec;
+    pageProgramDelayUsec = pageProgramUsec;
+}
+
+void EmuFlashBackend::setPowerCut(const uint64_t& bytes)
+{
+    powerCutArmed = true;
+    powerCut = false;
+    powerCutBytes = bytes;
+}
+
+void EmuFlashBackend::clearPowerCut()
+{
+    powerCutArmed = false;
+    powerCut = false;
+}
+
+std::vector<uint8_t> EmuFlashBackend::snapshot(const uint32_t& flash_ofs, const size_t& size) const
+{
+    return std::vector<uint8_t>(mem.begin() + flash_ofs, mem.begin() + flash_ofs + size);
+}
+
+void EmuFlashBackend::restore(const uint32_t& flash_ofs, const std::vector<uint8_t>& contents)
+{
+    std::copy(contents.begin(), contents.end(), mem.begin() + flash_ofs);
+    _writeThrough(flash_ofs, contents.size());
+}
+
+void EmuFlashBackend::printInfo() const
+{
+    printf("=== EmuFlashBackend ===\r\n");
+    printf("EraseCount: %d\r\n", static_cast<int>(eraseCount));
+    printf("EraseBytes: %lld\r\n", static_cast<long long>(eraseBytes));
+    printf("ProgramCount: %d\r\n", static_cast<int>(programCount));
+    printf("ProgramBytes: %lld\r\n", static_cast<long long>(programBytes));
+    printf("ViolationCount: %d\r\n", static_cast<int>(violationCount));
+}
+
+void EmuFlashBackend::_writeThrough(const uint32_t& flash_ofs, const size_t& size)
+{
+    if (fp == nullptr) { return; }
+    fseek(fp, flash_ofs, SEEK_SET);
+    fwrite(mem.data() + flash_ofs, 1, size, fp);
+    fflush(fp);
+}
+
+size_t EmuFlashBackend::_powerBudget(const size_t& size)
+{
+    // number of bytes actually erased or programmed before power cut
+    if (!powerCutArmed) { return size; }
+    const size_t n = static_cast<size_t>(std::min<uint64_t>(size, powerCutBytes));
+    powerCutBytes -= n;
+    if (n < size) { powerCut = true; }
+    return n;
+}
+}
@@ -0,0 +1,80 @@
+/*-----------------------------------------------------------/
+/ EmuFlashBackend.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+#include "FlashBackend.h"
+
+namespace FlashParamNs {
+//=================================
+// Interface of EmuFlashBackend class
+//=================================
+// RAM (optionally file) backed NOR flash emulator
+//   erase() sets bytes to 0xff and program() can only change bits from 1 to 0
+//   programming 0 to 1 is counted as violation (the bit stays 0 as real NOR flash)
+//   power cut can be injected at any byte of erase() and program() to test power-fail safety
+class EmuFlashBackend : public FlashBackend
+{
+public:
+    static EmuFlashBackend& instance(); // Singleton
+    const uint8_t* getReadAddr(const uint32_t& flash_ofs) const override;
+    void erase(const uint32_t& flash_ofs, const size_t& size) override;
+    void program(const uint32_t& flash_ofs, const uint8_t* data, const size_t& size) override;
+    bool safeExecute(void (*func)(void*), void* param, const uint32_t& timeout_ms) override;
+    void lock() override { mtx.lock(); }
+    void unlock() override { mtx.unlock(); }
+    uint64_t getTimeUs() const override;
+    bool open(const char* path);  // load from and write through to the file
+    void close();
+    void blank();
+    void resetCounters();
+    // power cut after the designated bytes of erase() and program() (bytes beyond are not changed)
+    void setPowerCut(const uint64_t& bytes);
+    void clearPowerCut();
+    bool isPowerCut() const { return powerCut; }
+    // emulate failure of safeExecute() (e.g. timeout to pause the other core), where func is not executed
+    void setSafeExecuteFailure(const bool& failure) { safeExecuteFailure = failure; }
+    // emulate time of erase per sector and program per page
+    void setDelay(const uint32_t& sectorEraseUsec, const uint32_t& pageProgramUsec);
+    // copy of flash contents to restore the same state repeatedly
+    std::vector<uint8_t> snapshot(const uint32_t& flash_ofs, const size_t& size) const;
+    void restore(const uint32_t& flash_ofs, const std::vector<uint8_t>& contents);
+    uint32_t getEraseCount() const { return eraseCount; }  // number of erased sectors
+    uint64_t getEraseBytes() const { return eraseBytes; }
+    uint32_t getProgramCount() const { return programCount; }  // number of programmed pages
+    uint64_t getProgramBytes() const { return programBytes; }
+    uint32_t getViolationCount() const { return violationCount; }
+    void printInfo() const;
+
+protected:
+    EmuFlashBackend();
+    virtual ~EmuFlashBackend();
+    EmuFlashBackend(const EmuFlashBackend&) = delete;
+    EmuFlashBackend& operator=(const EmuFlashBackend&) = delete;
+    void _writeThrough(const uint32_t& flash_ofs, const size_t& size);
+    size_t _powerBudget(const size_t& size);
+    std::vector<uint8_t> mem;
+    std::mutex mtx;
+    FILE* fp = nullptr;
+    uint32_t eraseCount = 0;
+    uint64_t eraseBytes = 0;
+    uint32_t programCount = 0;
+    uint64_t programBytes = 0;
+    uint32_t violationCount = 0;
+    uint32_t sectorEraseDelayUsec = 0;
+    uint32_t pageProgramDelayUsec = 0;
+    bool safeExecuteFailure = false;
+    bool powerCutArmed = false;
+    bool powerCut = false;
+    uint64_t powerCutBytes = 0;  // bytes left until power cut
+};
+}
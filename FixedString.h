@@ -0,0 +1,47 @@
+/*-----------------------------------------------------------/
+/ FixedString.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <array>
+#include <cstring>
+
+namespace FlashParamNs {
+//=================================
+// Interface of FixedString class
+//=================================
+// string of up to N characters with inline storage (no heap allocation)
+//   stored on flash as N bytes, which is the same format as Parameter<std::string> with size N
+template <size_t N>
+class FixedString
+{
+public:
+    FixedString() = default;
+    FixedString(const char* str) { assign(str); }
+    FixedString& operator=(const char* str) { assign(str); return *this; }
+    void assign(const char* str) {
+        size_t len = 0;
+        while (len < N && str[len] != '\0') { len++; }
+        std::memcpy(buf.data(), str, len);
+        std::memset(buf.data() + len, 0, buf.size() - len);
+    }
+    const char* c_str() const { return buf.data(); }
+    const char* data() const { return buf.data(); }
+    size_t length() const { return std::strlen(buf.data()); }
+    size_t size() const { return length(); }
+    bool empty() const { return buf[0] == '\0'; }
+    static constexpr size_t capacity() { return N; }
+    bool operator==(const char* str) const { return std::strcmp(buf.data(), str) == 0; }
+    bool operator!=(const char* str) const { return !(*this == str); }
+    bool operator==(const FixedString& other) const { return *this == other.c_str(); }
+    bool operator!=(const FixedString& other) const { return !(*this == other); }
+
+private:
+    std::array<char, N + 1> buf = {};  // buf[N] is always '\0'
+};
+}
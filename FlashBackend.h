@@ -0,0 +1,53 @@
+/*-----------------------------------------------------------/
+/ FlashBackend.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#if FLASH_PARAM_EMU
+// geometry of emulated flash (same as W25Q16JV on Raspberry Pi Pico)
+#ifndef FLASH_PAGE_SIZE
+#define FLASH_PAGE_SIZE (1u << 8)
+#endif
+#ifndef FLASH_SECTOR_SIZE
+#define FLASH_SECTOR_SIZE (1u << 12)
+#endif
+#ifndef PICO_FLASH_SIZE_BYTES
+#define PICO_FLASH_SIZE_BYTES (2 * 1024 * 1024)
+#endif
+#else
+#include "hardware/flash.h"
+#endif
+
+namespace FlashParamNs {
+//=================================
+// Interface of FlashBackend class
+//=================================
+class FlashBackend
+{
+public:
+    static FlashBackend& instance(); // Singleton of the platform default backend
+    virtual ~FlashBackend() = default;
+    // memory-mapped read address of flash_ofs
+    virtual const uint8_t* getReadAddr(const uint32_t& flash_ofs) const = 0;
+    // flash_ofs and size must be aligned to FLASH_SECTOR_SIZE
+    virtual void erase(const uint32_t& flash_ofs, const size_t& size) = 0;
+    // flash_ofs and size must be aligned to FLASH_PAGE_SIZE
+    virtual void program(const uint32_t& flash_ofs, const uint8_t* data, const size_t& size) = 0;
+    // execute func where erase() and program() are safe to call
+    //   the other core is paused meanwhile, therefore func can update the state guarded by lock() without it
+    virtual bool safeExecute(void (*func)(void*), void* param, const uint32_t& timeout_ms) = 0;
+    // guard of the state shared with the context committing asynchronously (keep the section short)
+    virtual void lock() = 0;
+    virtual void unlock() = 0;
+    // monotonic time in usec for the instrumentation (see FlashStats)
+    virtual uint64_t getTimeUs() const = 0;
+};
+}
@@ -13,47 +13,46 @@ namespace FlashParamNs {
 //=================================
 // Implementation of Parameter class
 //=================================
-template <class T>
-Parameter<T>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size)
-    : id(id), name(name), flashAddr(flashAddr), defaultValue(defaultValue), size(size)
+template <class T, class Enable>
+Parameter<T, Enable>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size)
+    : id(id), name(name), flashAddr(flashAddr), defaultValue(defaultValue), size(size), params(params)
 {
-    Params& params = Params::instance();
     params.add(id, this);
     params.setNextFlashAddr(flashAddr + size);
 }
-template Parameter<bool>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<uint8_t>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<uint16_t>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<uint32_t>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<uint64_t>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<int8_t>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<int16_t>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<int32_t>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<int64_t>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<float>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<double>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-template Parameter<std::string>::Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-
-template <class T>
-Parameter<T>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size)
-    : Parameter<T>(id, name, Params::instance().getNextFlashAddr(), defaultValue, size)
-{
-}
-template Parameter<bool>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<uint8_t>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<uint16_t>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<uint32_t>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<uint64_t>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<int8_t>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<int16_t>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<int32_t>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<int64_t>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<float>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<double>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-template Parameter<std::string>::Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-
-template <class T>
-const typename Parameter<T>::valueType& Parameter<T>::getFromFlash()
+template Parameter<bool>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<uint8_t>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<uint16_t>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<uint32_t>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<uint64_t>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<int8_t>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<int16_t>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<int32_t>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<int64_t>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<float>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<double>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+template Parameter<std::string>::Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+
+template <class T, class Enable>
+Parameter<T, Enable>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size)
+    : Parameter(params, id, name, params.getNextFlashAddr(), defaultValue, size)
+{
+}
+template Parameter<bool>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<uint8_t>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<uint16_t>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<uint32_t>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<uint64_t>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<int8_t>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<int16_t>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<int32_t>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<int64_t>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<float>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<double>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+template Parameter<std::string>::Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+
+template <class T, class Enable>
+const typename Parameter<T, Enable>::valueType& Parameter<T, Enable>::getFromFlash()
 {
     FlashParamNs::ReadFromFlashVisitor visitor;
     visitor(this);
@@ -72,82 +71,640 @@ template const typename Parameter<float>::valueType& Parameter<float>::getFromFl
 template const typename Parameter<double>::valueType& Parameter<double>::getFromFlash();
 template const typename Parameter<std::string>::valueType& Parameter<std::string>::getFromFlash();
 
+//=================================
+// Implementation of BlobParameter class
+//=================================
+BlobParameter::BlobParameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const size_t& size,
+                             uint8_t* valuePtr, const uint8_t* defaultPtr, const size_t& valueSize, const void* typeTag, const size_t& hashTypeIndex)
+    : id(id), name(name), flashAddr(flashAddr), size(size), valuePtr(valuePtr), defaultPtr(defaultPtr), valueSize(valueSize), typeTag(typeTag), hashTypeIndex(hashTypeIndex),
+      params(params)
+{
+    params.add(id, this);
+    params.setNextFlashAddr(flashAddr + size);
+}
+
+void BlobParameter::_notifyChange()
+{
+    params.changeCount++;
+    params.notifyChange(id, observers, notifyPending);
+}
+
+void BlobParameter::_useLayout(const uint32_t& mapHash)
+{
+    params.useLayout(mapHash);
+}
+
+#if FLASH_PARAM_LAZY_LOAD
+void BlobParameter::_fetchFromFlash() const
+{
+    // the value is cached on the first access even through const accessor
+    ReadFromFlashVisitor{}(const_cast<BlobParameter*>(this));
+    params.loadCount++;
+}
+#endif
+
 //=================================
 // Implementation of Params class
 //=================================
 Params& Params::instance()
 {
-    static Params instance; // Singleton
+    static Params instance(UserFlash::instance()); // Singleton
     return instance;
 }
 
 void Params::printInfo() const
 {
     printf("=== FlashParam ===\n");
-    for (const auto& [key, item] : paramMap) {
-        std::visit(PrintInfoVisitor{}, item);
+#if FLASH_PARAM_LAZY_LOAD
+    printf("LoadCount: %d / %d\n", static_cast<int>(loadCount), static_cast<int>(getNumParams()));
+#endif
+#if FLASH_PARAM_MIGRATION
+    printf("MigrateCount: %d\n", static_cast<int>(migrateCount));
+#if !FLASH_PARAM_SPARSE
+    if (hasRoomForSchema()) {
+        printf("Schema: %d bytes\n", static_cast<int>(schemaSizeOf(getNumParams())));
+    } else {
+        printf("Schema: none (no room in the image)\n");
     }
+#endif
+#endif
+#if FLASH_PARAM_SPARSE
+    printf("SparseSize: %d / %d\n", static_cast<int>(sparseSize), static_cast<int>(userFlash.getImageSize()));
+#endif
+    forEach([](const variant_t& item) {
+        std::visit(PrintInfoVisitor{}, item);
+    });
 }
 
 void Params::loadDefault()
 {
-    for (const auto& [key, item] : paramMap) {
+    forEach([](const variant_t& item) {
         std::visit([](auto&& param) {
             param->loadDefault();
         }, item);
-    }
+    });
 }
 
 void Params::loadFromFlash()
 {
-    for (const auto& [key, item] : paramMap) {
-        std::visit(ReadFromFlashVisitor{}, item);
+#if FLASH_PARAM_LAZY_LOAD
+    // only mark here, then each parameter is loaded on the first access
+    forEach([](const variant_t& item) {
+        std::visit([](auto&& param) {
+            param->pending = true;
+        }, item);
+    });
+#elif FLASH_PARAM_SPARSE
+    // parameters without record keep default loaded by initialize()
+    for (const uint32_t id : {CFG_MAP_HASH, CFG_STORE_COUNT}) {
+        std::visit(ReadFromFlashVisitor{}, paramTable.at(id));
+        loadCount++;
     }
+    loadCount += loadRecords();
+#elif FLASH_PARAM_XIP_READ
+    forEach([this](const variant_t& item) {
+        std::visit(MapToFlashVisitor{}, item);
+        loadCount++;
+    });
+#else
+    forEach([this](const variant_t& item) {
+        std::visit(ReadFromFlashVisitor{}, item);
+        loadCount++;
+    });
+#endif
+}
+
+void Params::remapToFlash()
+{
+    // after store, parameters on RAM can refer to flash again
+#if FLASH_PARAM_XIP_READ
+    // except for CFG_STORE_COUNT, whose value on flash is the base of store ticks
+    MapToFlashVisitor visitor;
+    visitor.readIfNotMapped = false;
+    forEach([&visitor](const variant_t& item) {
+        std::visit([&visitor](auto&& param) {
+            if (param->id != CFG_STORE_COUNT) { visitor(param); }
+        }, item);
+    });
+#endif
+}
+
+size_t Params::getNumParams() const
+{
+    size_t count = 0;
+    forEach([&count](const variant_t&) { count++; });
+    return count;
+}
+
+std::string_view Params::nameOf(const uint32_t& id) const
+{
+    if (id >= paramTable.size()) { return {}; }
+    return std::visit([](auto&& param) { return (param != nullptr) ? std::string_view(param->name) : std::string_view(); }, paramTable[id]);
+}
+
+void Params::detachFromFlash()
+{
+    forEach([](const variant_t& item) {
+        std::visit([](auto&& param) {
+            param->_detachFromFlash();
+        }, item);
+    });
+}
+
+void Params::clearDirty()
+{
+    forEach([](const variant_t& item) {
+        if (const auto blobPtr = std::get_if<BlobParameter*>(&item)) {
+            (*blobPtr)->_clearDirty();
+        }
+    });
 }
 
-bool Params::storeToFlash() const
+bool Params::reserveToFlash() const
 {
-    for (const auto& [key, item] : paramMap) {
+#if FLASH_PARAM_SPARSE
+    return reserveRecords();
+#else
+    forEach([](const variant_t& item) {
         std::visit(WriteReserveVisitor{}, item);
+    });
+#if FLASH_PARAM_MIGRATION
+    // the image is stored without the schema if it doesn't fit, where the next image of the other schema is loaded with default
+    if (hasRoomForSchema()) {
+        reserveSchema();
+    } else {
+        invalidateSchema();
+    }
+#endif
+    return true;
+#endif
+}
+
+#if FLASH_PARAM_SPARSE
+bool Params::reserveRecords() const
+{
+    const size_t imageSize = userFlash.getImageSize();
+    uint32_t addr = SparseRecordOfs;
+    bool fit = true;
+    forEach([this, &imageSize, &addr, &fit](const variant_t& item) {
+        std::visit([this, &imageSize, &addr, &fit](auto&& param) {
+            if (param->id < CFG_ID_BASE) {  // built-in parameters at the fixed address
+                WriteReserveVisitor{}(param);
+                return;
+            }
+            if (!fit || isDefault(param)) { return; }  // no flash byte for the default value
+            const uint32_t valueAddr = addr + sizeof(ParamRecord);
+            if (param->id >= RecordEnd || valueAddr + param->size > imageSize) {
+                fit = false;
+                return;
+            }
+            const ParamRecord record = {
+                static_cast<uint16_t>(param->id), static_cast<uint8_t>(typeIndexOf(param)), 0xff, static_cast<uint16_t>(param->size)
+            };
+            userFlash.writeReserve(addr, sizeof(record), record);
+            WriteReserveVisitor{valueAddr}(param);
+            addr = valueAddr + param->size;
+        }, item);
+    });
+    // the rest is blank, which also terminates the records
+    userFlash.fillReserve(addr, imageSize - addr, 0xff);
+    sparseSize = addr;
+    return fit;
+}
+
+size_t Params::loadRecords()
+{
+    // single pass over the records, where each value is read from flash directly into the parameter
+    const size_t imageSize = userFlash.getImageSize();
+    size_t count = 0;
+    uint32_t addr = SparseRecordOfs;
+    while (addr + sizeof(ParamRecord) <= imageSize) {
+        ParamRecord record = {};
+        userFlash.read(addr, sizeof(record), record);
+        const uint32_t valueAddr = addr + sizeof(record);
+        if (record.id == RecordEnd || valueAddr + record.size > imageSize) { break; }
+        addr = valueAddr + record.size;
+        if (record.id < CFG_ID_BASE || record.id >= paramTable.size()) { continue; }
+        std::visit([this, &record, &valueAddr, &count](auto&& param) {
+            // keep default if the parameter is removed, or its type or size is changed
+            if (param == nullptr || typeIndexOf(param) != record.typeIndex || param->size != record.size) { return; }
+            ReadFromFlashVisitor{valueAddr}(param);
+            count++;
+        }, paramTable[record.id]);
+    }
+    sparseSize = addr;
+    return count;
+}
+
+uint32_t Params::findRecord(const uint32_t& id, const size_t& typeIndex, const size_t& size, const uint32_t& flashAddr) const
+{
+    if (id < CFG_ID_BASE) { return flashAddr; }  // built-in parameters at the fixed address
+    const size_t imageSize = userFlash.getImageSize();
+    uint32_t addr = SparseRecordOfs;
+    while (addr + sizeof(ParamRecord) <= imageSize) {
+        ParamRecord record = {};
+        userFlash.read(addr, sizeof(record), record);
+        const uint32_t valueAddr = addr + sizeof(record);
+        if (record.id == RecordEnd || valueAddr + record.size > imageSize) { break; }
+        if (record.id == id) {
+            return (record.typeIndex == typeIndex && record.size == size) ? valueAddr : NoFlashAddr;
+        }
+        addr = valueAddr + record.size;
+    }
+    return NoFlashAddr;
+}
+#endif
+
+#if FLASH_PARAM_MIGRATION && !FLASH_PARAM_SPARSE
+bool Params::hasRoomForSchema() const
+{
+    const size_t imageSize = userFlash.getImageSize();
+    if (imageSize > MaxSchemaValue + 1 || paramTable.size() > MaxSchemaValue + 1) { return false; }
+    size_t size = 0;
+    forEach([&size](const variant_t& item) {
+        std::visit([&size](auto&& param) {
+            if (param->flashAddr + param->size > size) { size = param->flashAddr + param->size; }
+        }, item);
+    });
+    return size + schemaSizeOf(getNumParams()) <= imageSize;
+}
+
+void Params::invalidateSchema() const
+{
+    // the footer of the previous schema is erased unless parameters overwrite it
+    const size_t imageSize = userFlash.getImageSize();
+    bool overlap = false;
+    forEach([&imageSize, &overlap](const variant_t& item) {
+        std::visit([&imageSize, &overlap](auto&& param) {
+            if (param->flashAddr + param->size > imageSize - sizeof(SchemaFooter)) { overlap = true; }
+        }, item);
+    });
+    if (!overlap) { userFlash.fillReserve(imageSize - sizeof(SchemaFooter), sizeof(SchemaFooter), 0xff); }
+}
+
+void Params::reserveSchema() const
+{
+    const SchemaFooter footer = {static_cast<uint32_t>(getNumParams()), SchemaMagic};
+    uint32_t entryAddr = userFlash.getImageSize() - schemaSizeOf(footer.numEntries);
+    forEach([this, &entryAddr](const variant_t& item) {
+        std::visit([this, &entryAddr](auto&& param) {
+            const SchemaEntry entry = {
+                static_cast<uint16_t>(param->id), static_cast<uint8_t>(typeIndexOf(param)), 0xff,
+                static_cast<uint16_t>(param->flashAddr), static_cast<uint16_t>(param->size)
+            };
+            userFlash.writeReserve(entryAddr, sizeof(entry), entry);
+            entryAddr += sizeof(entry);
+        }, item);
+    });
+    userFlash.writeReserve(entryAddr, sizeof(footer), footer);
+}
+#endif
+
+#if FLASH_PARAM_MIGRATION
+void Params::migrateFromFlash()
+{
+#if FLASH_PARAM_SPARSE
+    // the records are self-describing, then those whose type and size still match are loaded as well as CFG_STORE_COUNT
+    std::visit(ReadFromFlashVisitor{}, paramTable.at(CFG_STORE_COUNT));
+    migrateCount += 1 + loadRecords();
+#else
+    const size_t imageSize = userFlash.getImageSize();
+    SchemaFooter footer = {};
+    userFlash.read(imageSize - sizeof(footer), sizeof(footer), footer);
+    // no schema if stored without FLASH_PARAM_MIGRATION (or the image size is changed)
+    if (footer.magic != SchemaMagic || footer.numEntries > (imageSize - sizeof(footer)) / sizeof(SchemaEntry)) { return; }
+    // single pass over the entries of the old schema, where each value is read from flash directly into the parameter
+    uint32_t entryAddr = imageSize - schemaSizeOf(footer.numEntries);
+    for (uint32_t i = 0; i < footer.numEntries; i++, entryAddr += sizeof(SchemaEntry)) {
+        SchemaEntry entry = {};
+        userFlash.read(entryAddr, sizeof(entry), entry);
+        // CFG_MAP_HASH is left as default since it's of the other schema
+        if (entry.id == CFG_MAP_HASH || entry.id >= paramTable.size() || entry.flashAddr + entry.size > imageSize) { continue; }
+        std::visit([this, &entry](auto&& param) {
+            // keep default if the parameter is removed, or its type or size is changed
+            if (param == nullptr || typeIndexOf(param) != entry.typeIndex || param->size != entry.size) { return; }
+            ReadFromFlashVisitor{entry.flashAddr}(param);
+            migrateCount++;
+        }, paramTable[entry.id]);
+    }
+#endif
+}
+#endif
+
+void Params::subscribe(const uint32_t& id, ChangeObserver& observer)
+{
+    std::visit([&observer](auto&& param) {
+        link(param->observers, observer);
+    }, itemAt(id));  // aborts for unknown id
+}
+
+void Params::unsubscribe(const uint32_t& id, ChangeObserver& observer)
+{
+    std::visit([&observer](auto&& param) {
+        unlink(param->observers, observer);
+    }, itemAt(id));  // aborts for unknown id
+}
+
+void Params::notifyChange(const uint32_t& id, ChangeObserver* observers, bool& notifyPending)
+{
+    if (observers == nullptr || muteNotify) { return; }
+    if (deferNotify) {
+        // multiple changes of a parameter are coalesced into a notification
+        if (!notifyPending) {
+            notifyPending = true;
+            deferredCount++;
+        }
+        return;
+    }
+    dispatch(id, observers);
+}
+
+void Params::notifyAll()
+{
+    forEach([this](const variant_t& item) {
+        std::visit([this](auto&& param) {
+            notifyChange(param->id, param->observers, param->notifyPending);
+        }, item);
+    });
+}
+
+size_t Params::dispatchChanges()
+{
+    if (deferredCount == 0) { return 0; }
+    size_t count = 0;
+    forEach([this, &count](const variant_t& item) {
+        std::visit([this, &count](auto&& param) {
+            if (!param->notifyPending) { return; }
+            param->notifyPending = false;
+            deferredCount--;
+            dispatch(param->id, param->observers);
+            count++;
+        }, item);
+    });
+    return count;
+}
+
+void Params::link(ChangeObserver*& head, ChangeObserver& observer)
+{
+    for (auto node = head; node != nullptr; node = node->next) {
+        if (node == &observer) { return; }  // already subscribed
+    }
+    observer.next = head;
+    head = &observer;
+}
+
+void Params::unlink(ChangeObserver*& head, ChangeObserver& observer)
+{
+    for (auto link = &head; *link != nullptr; link = &(*link)->next) {
+        if (*link == &observer) {
+            *link = observer.next;
+            observer.next = nullptr;
+            return;
+        }
+    }
+}
+
+void Params::dispatch(const uint32_t& id, ChangeObserver* observers)
+{
+    // next is kept before the call so that the observer can unsubscribe itself
+    for (auto node = observers; node != nullptr; ) {
+        auto next = node->next;
+        if (node->callback != nullptr) { node->callback(id, node->context); }
+        node = next;
     }
-    UserFlash& userFlash = UserFlash::instance();
-    return userFlash.program();
 }
 
 //=================================
 // Implementation of FlashParam class
 //=================================
+FlashParam::FlashParam()
+    : userFlash(UserFlash::instance()), params(Params::instance())
+{
+}
+
+FlashParam::FlashParam(const UserFlashRegion& region)
+    : ownedUserFlash(new UserFlash(region)), ownedParams(new Params(*ownedUserFlash)),
+      userFlash(*ownedUserFlash), params(*ownedParams)
+{
+}
+
 void FlashParam::initialize(bool preserveStoreCount)
+{
+    userFlash.waitIdle();
+    if (params.hasLayout && params.layoutMapHash != params.getMapHash()) { std::abort(); }  // parameters don't match Layout<>
+    const uint64_t startUs = userFlash.backend.getTimeUs();
+    params.loadCount = 0;
+    params.migrateCount = 0;
+    // observers are notified once per parameter after the values are settled
+    params.muteNotify = true;
+    _loadValues(preserveStoreCount);
+    params.muteNotify = false;
+    userFlash.stats.initialize.add(static_cast<uint32_t>(userFlash.backend.getTimeUs() - startUs));  // except for observers
+    params.notifyAll();
+    _markCommitted();
+}
+
+void FlashParam::_loadValues(bool preserveStoreCount)
 {
     loadDefault();
 
     // don't load from Flash if flash is blank
-    if (P_CFG_STORE_COUNT.getFromFlash() == 0xffffffffUL) {
+    const uint32_t storeBase = P_CFG_STORE_COUNT.getFromFlash();
+    if (storeBase == 0xffffffffUL) {
         return;
     }
 
-    auto& params = Params::instance();
     // don't load from Flash if hash value is different (parhaps format has changed)
     if (P_CFG_MAP_HASH.getFromFlash() != params.getMapHash()) {
         loadDefault(preserveStoreCount);
-        return;
+#if FLASH_PARAM_MIGRATION
+        // except for parameters whose type and size still match in the schema stored with the image
+        params.migrateFromFlash();
+#endif
+    } else {
+        // otherwise, load from Flash
+        params.loadFromFlash();
     }
 
-    // otherwise, load from Flash
-    params.loadFromFlash();
+    // CFG_STORE_COUNT loaded (or kept) from flash is the base, which is counted up by store ticks
+    const uint32_t ticks = static_cast<uint32_t>(userFlash.getStoreTicks());
+    if (ticks > 0 && P_CFG_STORE_COUNT.get() == storeBase) { P_CFG_STORE_COUNT.set(storeBase + ticks); }
 }
 
 bool FlashParam::finalize()
 {
-    auto& params = Params::instance();
-    P_CFG_MAP_HASH.set(params.getMapHash());
-    P_CFG_STORE_COUNT.set(P_CFG_STORE_COUNT.get() + 1);
-    return params.storeToFlash();
+    userFlash.waitIdle();
+    _settleAsync();
+    _updateMapHash();
+    if (!params.reserveToFlash()) {  // values which differ from default exceed the image (FLASH_PARAM_SPARSE)
+        return false;
+    }
+    _reserveStoreBase();
+    // nothing to store if no parameter has changed since the last store
+    if (!userFlash.isModified()) {
+        _markCommitted();
+        return true;
+    }
+    const uint32_t storeCount = P_CFG_STORE_COUNT.get();
+    const bool tick = _countUpStore(true);
+    if (!userFlash.program(tick)) {
+        // nothing is stored, then the count is to be counted up again by the next finalize()
+        P_CFG_STORE_COUNT.set(storeCount);
+        return false;
+    }
+    params.remapToFlash();
+    _markCommitted();
+    return true;
+}
+
+bool FlashParam::_countUpStore(bool inPlaceAware)
+{
+    // the image programmed in place without erase keeps the base and counts up by a store tick (fixed mode),
+    //   otherwise the base is counted up to the count, where store ticks are erased
+    const uint32_t storeCount = P_CFG_STORE_COUNT.get();
+    const bool tick = inPlaceAware && userFlash.canTickInPlace();
+    P_CFG_STORE_COUNT.set(storeCount + 1);
+    if (!tick) { WriteReserveVisitor{}(&P_CFG_STORE_COUNT); }
+    return tick;
+}
+
+void FlashParam::finalizeAsync(commit_callback_t callback, void* context)
+{
+    _settleAsync();  // the result of the previous request if it's already done
+    // parameters must not refer to flash, which can be erased in background
+    params.detachFromFlash();
+    _updateMapHash();
+    if (!params.reserveToFlash()) {  // values which differ from default exceed the image (FLASH_PARAM_SPARSE)
+        if (callback != nullptr) { callback(COMMIT_FAILURE, context); }
+        return;
+    }
+    _reserveStoreBase();
+    // nothing to store if no parameter has changed since the last store and no commit is pending
+    if (!userFlash.isBusy() && !userFlash.isModified()) {
+        _markCommitted();
+        if (callback != nullptr) { callback(COMMIT_SUCCESS, context); }
+        return;
+    }
+    // flash can be being programmed in background, then in place is not judged
+    asyncStoreCount = P_CFG_STORE_COUNT.get();
+    const bool tick = _countUpStore(!userFlash.isBusy());
+    userFlash.programAsync(callback, context, tick);
+    // the changes are regarded as committed when the result turns out to be success (_settleAsync())
+    asyncPending = true;
+    asyncChangeCount = params.getChangeCount();
+    asyncReason = nullptr;
+}
+
+bool FlashParam::_settleAsync()
+{
+    if (!asyncPending || userFlash.isBusy()) { return true; }
+    asyncPending = false;
+    auto& stats = autoCommitStats;
+    if (userFlash.getLastResult() != COMMIT_SUCCESS) {
+        // nothing is stored, then the count is to be counted up again by the next commit
+        P_CFG_STORE_COUNT.set(asyncStoreCount);
+        if (asyncReason != nullptr) { stats.failures++; }
+        return false;
+    }
+    committedChangeCount = asyncChangeCount;
+    observedChangeCount = committedChangeCount;
+    // dirty flags are kept if changed after the request, which is not in the committed image
+    if (params.getChangeCount() == asyncChangeCount) { params.clearDirty(); }
+    if (asyncReason != nullptr) {
+        (*asyncReason)++;
+        stats.commits++;
+        stats.changes += asyncChanges;
+    }
+    return true;
+}
+
+bool FlashParam::serviceFinalize()
+{
+    return userFlash.service();
+}
+
+bool FlashParam::isFinalizing() const
+{
+    return userFlash.isBusy();
+}
+
+CommitResult_t FlashParam::getFinalizeResult() const
+{
+    return userFlash.getLastResult();
+}
+
+void FlashParam::enableAutoCommit(const AutoCommitConfig& config)
+{
+    autoCommitConfig = config;
+    autoCommitEnabled = true;
+    // changes made so far are regarded as made now
+    observedChangeCount = committedChangeCount;
+}
+
+void FlashParam::setDeferredNotify(bool deferred)
+{
+    params.deferNotify = deferred;
+    // notifications held so far are not to be lost
+    if (!deferred) { params.dispatchChanges(); }
+}
+
+bool FlashParam::serviceAutoCommit(const uint32_t& nowMs)
+{
+    if (!autoCommitEnabled) { return false; }
+    if (!_settleAsync()) {
+        // retry after the quiet period
+        observedChangeCount = params.getChangeCount();
+        firstChangeMs = nowMs;
+        lastChangeMs = nowMs;
+        return false;
+    }
+    if (asyncPending) { return false; }  // wait for the result of the commit in background
+    const uint32_t changeCount = params.getChangeCount();
+    const uint32_t pending = changeCount - committedChangeCount;
+    if (pending == 0) { return false; }
+    if (changeCount != observedChangeCount) {
+        // the first change after the last commit starts the max delay period
+        if (observedChangeCount == committedChangeCount) { firstChangeMs = nowMs; }
+        lastChangeMs = nowMs;
+        observedChangeCount = changeCount;
+    }
+    // time comparison by difference to be safe with wrap around of nowMs
+    const auto& config = autoCommitConfig;
+    auto& stats = autoCommitStats;
+    uint32_t* reason;
+    if (config.maxPending > 0 && pending >= config.maxPending) {
+        reason = &stats.byMaxPending;
+    } else if (config.maxDelayMs > 0 && nowMs - firstChangeMs >= config.maxDelayMs) {
+        reason = &stats.byMaxDelay;
+    } else if (nowMs - lastChangeMs >= config.quietMs) {
+        reason = &stats.byQuiet;
+    } else {
+        return false;
+    }
+    if (config.async) {
+        // counted when it succeeds
+        finalizeAsync();
+        if (asyncPending) {
+            asyncReason = reason;
+            asyncChanges = pending;
+            return true;
+        }
+    } else if (!finalize()) {
+        // retry after the quiet period
+        stats.failures++;
+        observedChangeCount = params.getChangeCount();  // the built-in parameters are changed by finalize()
+        firstChangeMs = nowMs;
+        lastChangeMs = nowMs;
+        return false;
+    }
+    (*reason)++;
+    stats.commits++;
+    stats.changes += pending;
+    return true;
 }
 
 void FlashParam::loadDefault(bool preserveStoreCount)
 {
-    auto& params = Params::instance();
     auto storeCount = P_CFG_STORE_COUNT.get();
     params.loadDefault();
     if (preserveStoreCount) { P_CFG_STORE_COUNT.set(storeCount); }
@@ -155,9 +712,14 @@ void FlashParam::loadDefault(bool preserveStoreCount)
 
 void FlashParam::printInfo() const
 {
-    auto& userFlash = UserFlash::instance();
     userFlash.printInfo();
-    auto& params = Params::instance();
     params.printInfo();
+    if (autoCommitEnabled) {
+        const auto& stats = autoCommitStats;
+        printf("AutoCommit: pending %d, commits %d (quiet %d, maxDelay %d, maxPending %d), changes %d, saved %d, failures %d\n",
+            static_cast<int>(getPendingChanges()), static_cast<int>(stats.commits),
+            static_cast<int>(stats.byQuiet), static_cast<int>(stats.byMaxDelay), static_cast<int>(stats.byMaxPending),
+            static_cast<int>(stats.changes), static_cast<int>(stats.getSaved()), static_cast<int>(stats.failures));
+    }
 }
 }
@@ -8,42 +8,292 @@
 
 #pragma once
 
-#include <map>
+#include <array>
+#include <cstdlib>
 #include <string>
 #include <cinttypes>  // this must be located at later than <string>
+#include <memory>
+#include <type_traits>
 #include <variant>
+#include <vector>
 
+#include "Counter.h"
+#include "FixedString.h"
+#include "NameIndex.h"
+#include "SeqLock.h"
 #include "UserFlash.h"
 
+// FLASH_PARAM_LAZY_LOAD
+//   0 (default): all parameters are loaded from flash by initialize()
+//   1          : initialize() only validates CFG_STORE_COUNT and CFG_MAP_HASH,
+//                then each parameter is loaded from flash on its first access
+#ifndef FLASH_PARAM_LAZY_LOAD
+#define FLASH_PARAM_LAZY_LOAD 0
+#endif
+
+// FLASH_PARAM_MULTICORE_SAFE
+//   0 (default): parameters are accessed only from the core which calls set() and finalize()
+//   1          : load() returns a consistent copy of the value on any core even while the value is written
+//                on the other core (sequence lock per parameter, readers never block the writer)
+#ifndef FLASH_PARAM_MULTICORE_SAFE
+#define FLASH_PARAM_MULTICORE_SAFE 0
+#endif
+#if FLASH_PARAM_MULTICORE_SAFE && FLASH_PARAM_LAZY_LOAD
+#error "FLASH_PARAM_MULTICORE_SAFE is not available with FLASH_PARAM_LAZY_LOAD"
+#endif
+
+// FLASH_PARAM_MIGRATION
+//   0 (default): all parameters are reset to default when CFG_MAP_HASH is changed
+//   1          : the schema (id, type and size of each parameter) is stored at the end of the image,
+//                then initialize() keeps the values of parameters whose type and size still match when CFG_MAP_HASH is changed
+//                (the image is stored without the schema if the schema doesn't fit in the image after the parameters)
+#ifndef FLASH_PARAM_MIGRATION
+#define FLASH_PARAM_MIGRATION 0
+#endif
+
+// FLASH_PARAM_SPARSE
+//   0 (default): each parameter occupies its size at its flash address in the image
+//   1          : only the parameters whose values differ from default are stored as records of id, type and size,
+//                and the flash address of each parameter is used only for CFG_MAP_HASH
+//                (the records are self-describing, then no schema is stored with FLASH_PARAM_MIGRATION)
+#ifndef FLASH_PARAM_SPARSE
+#define FLASH_PARAM_SPARSE 0
+#endif
+#if FLASH_PARAM_SPARSE && FLASH_PARAM_XIP_READ
+#error "FLASH_PARAM_SPARSE is not available with FLASH_PARAM_XIP_READ"
+#endif
+
 namespace FlashParamNs {
+class Params;
+
+// called on change of the value of the parameter with id (see Parameter<T>::subscribe() and FlashParam::subscribe())
+using change_callback_t = void (*)(const uint32_t& id, void* context);
+
+// node of the observer list of a parameter, which is owned by the subscriber (no heap allocation)
+//   a node can be subscribed to only one parameter at a time
+struct ChangeObserver {
+    change_callback_t callback = nullptr;
+    void* context = nullptr;
+    ChangeObserver* next = nullptr;  // managed by subscribe() / unsubscribe()
+};
+
+// format of exportTo() / importFrom()
+typedef enum {
+    STREAM_BINARY = 0,  // header followed by records of id, type, size and value in the flash format
+    STREAM_TEXT,        // a line of "id name type size value" per parameter
+} StreamFormat_t;
+
+// called with each chunk of the export stream, which returns false to abort
+using export_sink_t = bool (*)(const uint8_t* data, const size_t& size, void* context);
+// called to fill buf with the import stream up to size bytes, which returns the number of bytes filled (0: end of the stream)
+using import_source_t = size_t (*)(uint8_t* buf, const size_t& size, void* context);
+
+struct ImportResult {
+    uint32_t applied = 0;   // parameters set from the stream
+    uint32_t rejected = 0;  // entries skipped by unknown id, mismatch of type or size, or malformed value
+    bool complete = false;  // the stream is read until its end without error
+};
+
+// flash address and size resolved at compile time by Layout<> (see ParamLayout.h)
+template <class T>
+struct LayoutItem {
+    uint32_t id;
+    uint32_t flashAddr;
+    size_t size;
+    uint32_t mapHash;  // CFG_MAP_HASH of Layout<>, which is checked against the parameters by initialize()
+};
+
+// aggregate types stored as contiguous bytes (see Parameter<T> for aggregate types)
+template <typename T>
+struct IsAggregateValue { static constexpr bool value = std::is_class_v<T> && std::is_trivially_copyable_v<T>; };
+template <size_t N>
+struct IsAggregateValue<FixedString<N>> { static constexpr bool value = false; };
+template <size_t N>
+struct IsAggregateValue<Counter<N>> { static constexpr bool value = false; };
+
+// elements of the aggregate type tracked by isDirty(), where the struct is a single element
+template <typename T>
+struct AggregateTraits {
+    using elementType = T;
+    static constexpr bool isArray = false;
+    static constexpr size_t numElements = 1;
+};
+template <typename E, size_t N>
+struct AggregateTraits<std::array<E, N>> {
+    using elementType = E;
+    static constexpr bool isArray = true;
+    static constexpr size_t numElements = N;
+};
+
 //=================================
 // Interface of Parameter class
 //=================================
-template <class T>
+template <class T, class Enable = void>
 class Parameter {
     using valueType = T;
 public:
-    Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
-    Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue) : Parameter(id, name, flashAddr, defaultValue, sizeof(T)) {};
-    Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
-    Parameter(const uint32_t& id, const char* name, const valueType& defaultValue) : Parameter(id, name, defaultValue, sizeof(T)) {};
-    void set(const valueType& value_) { value = value_; }
-    const valueType& get() const { return value; }
-    void loadDefault() { value = defaultValue; }
+    // parameter of the default partition
+    Parameter(const LayoutItem<T>& item, const char* name, const valueType& defaultValue) : Parameter(_defaultParams(), item, name, defaultValue) {};
+    Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size) : Parameter(_defaultParams(), id, name, flashAddr, defaultValue, size) {};
+    Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue) : Parameter(_defaultParams(), id, name, flashAddr, defaultValue) {};
+    Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size) : Parameter(_defaultParams(), id, name, defaultValue, size) {};
+    Parameter(const uint32_t& id, const char* name, const valueType& defaultValue) : Parameter(_defaultParams(), id, name, defaultValue) {};
+    // parameter of the partition of params (FlashParam::params of the class constructed with UserFlashRegion)
+    Parameter(Params& params, const LayoutItem<T>& item, const char* name, const valueType& defaultValue) : Parameter(params, item.id, name, item.flashAddr, defaultValue, item.size) { _useLayout(item.mapHash); };
+    Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size);
+    Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue) : Parameter(params, id, name, flashAddr, defaultValue, sizeof(T)) {};
+    Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size);
+    Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue) : Parameter(params, id, name, defaultValue, sizeof(T)) {};
+    void set(const valueType& value_) { _beginWrite(); value = value_; _useRamValue(); _endWrite(); _notifyChange(); }
+    const valueType& get() const {
+        _fetch();
+#if FLASH_PARAM_XIP_READ
+        return *ref;
+#else
+        return value;
+#endif
+    }
+    // copy of the value, which is consistent even if called from the other core while set() (FLASH_PARAM_MULTICORE_SAFE)
+    valueType load() const {
+#if FLASH_PARAM_MULTICORE_SAFE
+        static_assert(std::is_trivially_copyable_v<valueType>, "use FixedString<N> instead of std::string for load()");
+        valueType copy;
+        seqLock.read([this, &copy]() { copy = get(); });
+        return copy;
+#else
+        return get();
+#endif
+    }
+    void loadDefault() { _beginWrite(); value = defaultValue; _useRamValue(); _endWrite(); _notifyChange(); }
     const valueType& getDefault() const { return defaultValue; }
     const valueType& getFromFlash();
+    // observer is called on set(), loadDefault() and initialize()
+    void subscribe(ChangeObserver& observer);
+    void unsubscribe(ChangeObserver& observer);
 private:
     Parameter(const Parameter&) = delete;
     Parameter& operator=(const Parameter&) = delete;  // don't permit copy
+    static Params& _defaultParams();
+    void _useRamValue() {
+#if FLASH_PARAM_XIP_READ
+        ref = &value;
+#endif
+#if FLASH_PARAM_LAZY_LOAD
+        pending = false;
+#endif
+    }
+#if FLASH_PARAM_LAZY_LOAD
+    void _fetch() const { if (pending) { _fetchFromFlash(); } }
+    void _fetchFromFlash() const;
+#else
+    void _fetch() const {}
+#endif
+    void _notifyChange();  // count up pending changes for auto commit and notify observers
+    void _useLayout(const uint32_t& mapHash);  // constructed by Layout<>::item<Id>()
+#if FLASH_PARAM_MULTICORE_SAFE
+    void _beginWrite() { seqLock.beginWrite(); }
+    void _endWrite() { seqLock.endWrite(); }
+#else
+    void _beginWrite() {}
+    void _endWrite() {}
+#endif
+    // hold the value on RAM not to refer to flash
+    void _detachFromFlash() {
+        _fetch();
+#if FLASH_PARAM_XIP_READ
+        if (ref != &value) {
+            _beginWrite();
+            value = *ref;
+            ref = &value;
+            _endWrite();
+        }
+#endif
+    }
     const uint32_t id;
     const char* name;
     const uint32_t flashAddr;
     const valueType defaultValue;
     const size_t size;
+    Params& params;  // partition which the parameter belongs to
     valueType value = defaultValue;
+#if FLASH_PARAM_XIP_READ
+    const valueType* ref = &value;  // value on XIP-mapped flash while unmodified, otherwise &value
+#endif
+#if FLASH_PARAM_LAZY_LOAD
+    bool pending = false;  // value is to be loaded from flash on the first access
+#endif
+#if FLASH_PARAM_MULTICORE_SAFE
+    SeqLock seqLock;  // guard of value (and ref) for load() on the other core
+#endif
+    ChangeObserver* observers = nullptr;
+    bool notifyPending = false;  // changed while notification is deferred
     friend class Params;
     friend class FlashParam;
     friend class ReadFromFlashVisitor;
+    friend class MapToFlashVisitor;
+    friend class WriteReserveVisitor;
+    friend class PrintInfoVisitor;
+};
+
+//=================================
+// Interface of BlobParameter class
+//=================================
+// type-erased base of parameters whose value is stored as contiguous bytes (e.g. Parameter<FixedString<N>>)
+class BlobParameter {
+protected:
+    BlobParameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const size_t& size,
+                  uint8_t* valuePtr, const uint8_t* defaultPtr, const size_t& valueSize, const void* typeTag, const size_t& hashTypeIndex);
+    ~BlobParameter() = default;
+    BlobParameter(const BlobParameter&) = delete;
+    BlobParameter& operator=(const BlobParameter&) = delete;  // don't permit copy
+    void loadDefault() { _beginWrite(); std::memcpy(valuePtr, defaultPtr, valueSize); _useRamValue(); _endWrite(); _markDirty(); _notifyChange(); }
+    void _useRamValue() {
+#if FLASH_PARAM_LAZY_LOAD
+        pending = false;
+#endif
+    }
+    // bytes of the value beyond the flash size (FixedString<N> with size < N) are cleared after the value is read in the flash format
+    void _clearTail() { if (size < valueSize) { std::memset(valuePtr + size, 0, valueSize - size); } }
+    // dirty tracking of the aggregate types: the whole value is set through the type-erased path, and cleared on commit
+    virtual void _markDirty() {}
+    virtual void _clearDirty() {}
+#if FLASH_PARAM_LAZY_LOAD
+    void _fetch() const { if (pending) { _fetchFromFlash(); } }
+    void _fetchFromFlash() const;
+#else
+    void _fetch() const {}
+#endif
+    void _notifyChange();  // count up pending changes for auto commit and notify observers
+    void _useLayout(const uint32_t& mapHash);  // constructed by Layout<>::item<Id>()
+#if FLASH_PARAM_MULTICORE_SAFE
+    void _beginWrite() { seqLock.beginWrite(); }
+    void _endWrite() { seqLock.endWrite(); }
+#else
+    void _beginWrite() {}
+    void _endWrite() {}
+#endif
+    void _detachFromFlash() { _fetch(); }
+    virtual void printValue() const = 0;
+    const uint32_t id;
+    const char* name;
+    const uint32_t flashAddr;
+    const size_t size;
+    uint8_t* const valuePtr;
+    const uint8_t* const defaultPtr;
+    const size_t valueSize;
+    const void* const typeTag;  // to identify derived type without RTTI
+    const size_t hashTypeIndex;
+    Params& params;  // partition which the parameter belongs to
+#if FLASH_PARAM_LAZY_LOAD
+    bool pending = false;  // value is to be loaded from flash on the first access
+#endif
+#if FLASH_PARAM_MULTICORE_SAFE
+    SeqLock seqLock;  // guard of value for load() on the other core
+#endif
+    ChangeObserver* observers = nullptr;
+    bool notifyPending = false;  // changed while notification is deferred
+    friend class Params;
+    friend class ReadFromFlashVisitor;
     friend class WriteReserveVisitor;
     friend class PrintInfoVisitor;
 };
@@ -52,44 +302,42 @@ using variant_t = std::variant<
     Parameter<bool>*,
     Parameter<uint8_t>*, Parameter<uint16_t>*, Parameter<uint32_t>*, Parameter<uint64_t>*,
     Parameter<int8_t>*, Parameter<int16_t>*, Parameter<int32_t>*, Parameter<int64_t>*,
-    Parameter<float>*, Parameter<double>*, Parameter<std::string>*
+    Parameter<float>*, Parameter<double>*, Parameter<std::string>*,
+    BlobParameter*
     >;
 
-//=================================
-// Interface of Visitors
-//=================================
-struct FlashVisitor {
-    UserFlash& userFlash = UserFlash::instance();
-};
-
-struct ReadFromFlashVisitor : FlashVisitor {
-    template <typename T>
-    void operator()(const T& param) const {
-        userFlash.read(param->flashAddr, param->size, param->value);
+template <typename T, typename V, size_t I = 0>
+constexpr size_t variantIndexOf()
+{
+    if constexpr (I >= std::variant_size_v<V>) {
+        return I;
+    } else if constexpr (std::is_same_v<std::variant_alternative_t<I, V>, T>) {
+        return I;
+    } else {
+        return variantIndexOf<T, V, I + 1>();
     }
-};
+}
 
-struct WriteReserveVisitor : FlashVisitor {
-    template <typename T>
-    void operator()(const T& param) const {
-        userFlash.writeReserve(param->flashAddr, param->size, param->value);
-    }
+// type index for CFG_MAP_HASH, where the types with the same flash format share the index
+template <typename T>
+struct HashTypeIndex {
+    static constexpr size_t value = IsAggregateValue<T>::value ? variantIndexOf<BlobParameter*, variant_t>() : variantIndexOf<Parameter<T>*, variant_t>();
 };
+template <size_t N>
+struct HashTypeIndex<FixedString<N>> { static constexpr size_t value = variantIndexOf<Parameter<std::string>*, variant_t>(); };
+template <size_t N>
+struct HashTypeIndex<Counter<N>> { static constexpr size_t value = variantIndexOf<BlobParameter*, variant_t>(); };
 
-struct PrintInfoVisitor {
-    void operator()(const Parameter<bool>* param) const { printf("0x%04x %s: %s\n", param->flashAddr, param->name, param->value ? "true" : "false"); }
-    void operator()(const Parameter<uint8_t>* param) const { printf("0x%04x %s: %" PRIu8 "d (0x%" PRIx8 ")\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<uint16_t>* param) const { printf("0x%04x %s: %" PRIu16 "d (0x%" PRIx16 ")\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<uint32_t>* param) const { printf("0x%04x %s: %" PRIu32 "d (0x%" PRIx32 ")\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<uint64_t>* param) const { printf("0x%04x %s: %" PRIu64 "d (0x%" PRIx64 ")\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<int8_t>* param) const { printf("0x%04x %s: %" PRIi8 "d (0x%" PRIx8 ")\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<int16_t>* param) const { printf("0x%04x %s: %" PRIi16 "d (0x%" PRIx16 ")\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<int32_t>* param) const { printf("0x%04x %s: %" PRIi32 "d (0x%" PRIx32 ")\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<int64_t>* param) const { printf("0x%04x %s: %" PRIi64 "d (0x%" PRIx64 ")\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<float>* param) const { printf("0x%04x %s: %7.4f (%7.4e)\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<double>* param) const { printf("0x%04x %s: %7.4f (%7.4e)\n", param->flashAddr, param->name, param->value, param->value); }
-    void operator()(const Parameter<std::string>* param) const { printf("0x%04x %s: %s\n", param->flashAddr, param->name, param->value.c_str()); }
-};
+// default size on flash
+template <typename T>
+struct FlashSize { static constexpr size_t value = sizeof(T); };
+template <size_t N>
+struct FlashSize<FixedString<N>> { static constexpr size_t value = N; };
+// size on flash is always the size of the type
+template <typename T>
+struct HasFixedFlashSize { static constexpr bool value = IsAggregateValue<T>::value; };
+template <size_t N>
+struct HasFixedFlashSize<Counter<N>> { static constexpr bool value = true; };
 
 //=================================
 // Interface of Params class
@@ -100,34 +348,591 @@ class Params
     static constexpr uint32_t PRIME0 = 0x61e77795;
     static constexpr uint32_t PRIME1 = 0x8089f3a3;
     static constexpr uint32_t PRIME2 = 0xcdae6891;
-    static Params& instance(); // Singleton
+    static constexpr uint32_t MapHashSeed = FLASH_PARAM_SPARSE ? 0x53525053 : 0;  // "SPRS": the image of the other format is not loaded
+    // schema of the image for migration (FLASH_PARAM_MIGRATION), located at the end of the image
+    //   entries of all parameters in the order of id followed by the footer
+    struct SchemaEntry {
+        uint16_t id;
+        uint8_t typeIndex;
+        uint8_t reserved;
+        uint16_t flashAddr;
+        uint16_t size;
+    };
+    struct SchemaFooter {
+        uint32_t numEntries;
+        uint32_t magic;
+    };
+    static constexpr uint32_t SchemaMagic = 0x4d484353;  // "SCHM"
+    static constexpr size_t MaxSchemaValue = 0xffff;  // limit of id, flash address and size in SchemaEntry
+    static constexpr bool StoreSchema = FLASH_PARAM_MIGRATION && !FLASH_PARAM_SPARSE;
+    static constexpr size_t schemaSizeOf(const size_t& numParams) {
+        return StoreSchema ? numParams * sizeof(SchemaEntry) + sizeof(SchemaFooter) : 0;
+    }
+    // record of a parameter followed by the value of size bytes, which is terminated by id = RecordEnd
+    //   FLASH_PARAM_SPARSE: records of the parameters whose values differ from default, located next to the built-in parameters
+    //   STREAM_BINARY     : records of all parameters except for the built-in parameters, following StreamHeader
+    struct ParamRecord {
+        uint16_t id;
+        uint8_t typeIndex;
+        uint8_t reserved;
+        uint16_t size;
+    };
+    static constexpr uint16_t RecordEnd = 0xffff;
+    static constexpr uint32_t SparseRecordOfs = sizeof(uint32_t) * 2;  // after CFG_MAP_HASH and CFG_STORE_COUNT
+    static constexpr uint32_t NoFlashAddr = 0xffffffffUL;
+    struct StreamHeader {
+        uint32_t magic;
+        uint32_t mapHash;  // for information, since each record is validated by id, type and size
+    };
+    static constexpr uint32_t StreamMagic = 0x4e425046;  // "FPBN"
+    static Params& instance(); // Singleton of the default partition
+    explicit Params(UserFlash& userFlash) : userFlash(userFlash) {}
+    UserFlash& getUserFlash() const { return userFlash; }
     void printInfo() const;
     void loadDefault();
     void loadFromFlash();
-    bool storeToFlash() const;
+    void remapToFlash();
+    void detachFromFlash();
+    void clearDirty();
+    bool reserveToFlash() const;
+#if FLASH_PARAM_MIGRATION
+    void migrateFromFlash();
+#endif
+#if FLASH_PARAM_MIGRATION && !FLASH_PARAM_SPARSE
+    bool hasRoomForSchema() const;
+    void reserveSchema() const;
+    void invalidateSchema() const;
+#endif
+#if FLASH_PARAM_SPARSE
+    bool reserveRecords() const;
+    size_t loadRecords();
+    uint32_t findRecord(const uint32_t& id, const size_t& typeIndex, const size_t& size, const uint32_t& flashAddr) const;
+#endif
+    // flash address of the value of the parameter
+    //   FLASH_PARAM_SPARSE: address in its record, or NoFlashAddr if not stored since the value equals default
+    template <typename T>
+    uint32_t flashAddrOf(T* param) const {
+#if FLASH_PARAM_SPARSE
+        return findRecord(param->id, typeIndexOf(param), param->size, param->flashAddr);
+#else
+        return param->flashAddr;
+#endif
+    }
+    // streaming export / import (FlashParamStream.cpp)
+    bool exportTo(const StreamFormat_t& format, export_sink_t sink, void* context) const;
+    ImportResult importFrom(const StreamFormat_t& format, import_source_t source, void* context);
+    // change notification
+    void subscribe(const uint32_t& id, ChangeObserver& observer);
+    void unsubscribe(const uint32_t& id, ChangeObserver& observer);
+    void notifyChange(const uint32_t& id, ChangeObserver* observers, bool& notifyPending);
+    void notifyAll();
+    size_t dispatchChanges();
+    static void link(ChangeObserver*& head, ChangeObserver& observer);
+    static void unlink(ChangeObserver*& head, ChangeObserver& observer);
+    static void dispatch(const uint32_t& id, ChangeObserver* observers);
     template <typename T>
     void add(const uint32_t& id, T* param) {
-        paramMap[id] = param;
+        // ids are dense from zero, then table is indexed directly by id (unused ids hold nullptr)
+        //   capacity grows by power of 2, then parameters added one by one by static constructors reallocate the table only a few times
+        if (id >= paramTable.size()) {
+            if (id >= paramTable.capacity()) {
+                size_t capacity = MinTableCapacity;
+                while (capacity <= id) { capacity <<= 1; }
+                paramTable.reserve(capacity);
+            }
+            paramTable.resize(id + 1);
+        }
+        paramTable[id] = param;
         // update mapHash
-        const variant_t item = param;
-        mapHash += param->flashAddr*PRIME0 + param->size*PRIME1 + item.index()*PRIME2;
+        mapHash += param->flashAddr*PRIME0 + param->size*PRIME1 + typeIndexOf(param)*PRIME2;
+    }
+    // the value equals default, which is compared as bytes on flash
+    template <typename T>
+    static bool isDefault(T* param) {
+        if constexpr (std::is_same_v<T, BlobParameter>) {
+            param->_fetch();
+            return std::memcmp(param->valuePtr, param->defaultPtr, param->size) == 0;
+        } else if constexpr (std::is_trivially_copyable_v<typename T::valueType>) {
+            return std::memcmp(&param->get(), &param->defaultValue, sizeof(typename T::valueType)) == 0;
+        } else {
+            return param->get() == param->defaultValue;
+        }
+    }
+    // type index for CFG_MAP_HASH and the schema
+    template <typename T>
+    static size_t typeIndexOf(T* param) {
+        if constexpr (std::is_same_v<T, BlobParameter>) {
+            return param->hashTypeIndex;
+        } else {
+            const variant_t item = param;
+            return item.index();
+        }
     }
+    // item of the parameter with id, which aborts for the id without parameter (gap of the table or beyond the table)
+    variant_t& itemAt(const uint32_t& id) {
+        if (id >= paramTable.size() || !std::visit([](auto&& param) { return param != nullptr; }, paramTable[id])) { std::abort(); }  // no parameter with id
+        return paramTable[id];
+    }
+    // aborts for the type which doesn't match the parameter as well as for unknown id
     template <typename T>
     T& getParam(const uint32_t& id) {
-        auto& item = paramMap.at(id);
-        auto& paramPtr = std::get<T*>(item);
-        return *paramPtr;
+        auto& item = itemAt(id);
+        if constexpr (std::is_base_of_v<BlobParameter, T>) {
+            auto* blobPtr = std::get_if<BlobParameter*>(&item);
+            if (blobPtr == nullptr || (*blobPtr)->typeTag != &T::TypeTag) { std::abort(); }  // type mismatch
+            return *static_cast<T*>(*blobPtr);
+        } else {
+            auto* paramPtr = std::get_if<T*>(&item);
+            if (paramPtr == nullptr) { std::abort(); }  // type mismatch
+            return **paramPtr;
+        }
+    }
+    template <typename F>
+    void forEach(F&& func) const {
+        for (const auto& item : paramTable) {
+            if (std::visit([](auto&& param) { return param != nullptr; }, item)) {
+                func(item);
+            }
+        }
+    }
+    // all parameters constructed by Layout<>::item<Id>() are to be of the same Layout<>
+    void useLayout(const uint32_t& mapHash) {
+        if (hasLayout && layoutMapHash != mapHash) { std::abort(); }  // parameters of the other Layout<> in the partition
+        hasLayout = true;
+        layoutMapHash = mapHash;
     }
     uint32_t getNextFlashAddr() const { return nextFlashAddr; }
     void setNextFlashAddr(uint32_t addr) { nextFlashAddr = addr; }
     uint32_t getMapHash() const { return mapHash; }
-    std::map<const uint32_t, variant_t> paramMap;
+    size_t getNumParams() const;
+    std::string_view nameOf(const uint32_t& id) const;  // empty if no parameter has the id
+    size_t getLoadCount() const { return loadCount; }
+    size_t getMigrateCount() const { return migrateCount; }
+    uint32_t getChangeCount() const { return changeCount; }
+    UserFlash& userFlash;
+    static constexpr size_t MinTableCapacity = 32;
+    std::vector<variant_t> paramTable;
     uint32_t nextFlashAddr = 0;
-    uint32_t mapHash = 0;
-    template<typename> friend class Parameter;  // for all Parameter<> classes
+    uint32_t mapHash = MapHashSeed;
+    bool hasLayout = false;  // some of the parameters are constructed by Layout<>::item<Id>()
+    uint32_t layoutMapHash = 0;  // CFG_MAP_HASH computed by Layout<> at compile time
+    size_t loadCount = 0;  // number of parameters loaded from flash since initialize()
+    size_t migrateCount = 0;  // number of parameters migrated from the image of the other schema by initialize()
+    mutable size_t sparseSize = 0;  // bytes of the built-in parameters and the records in the image (FLASH_PARAM_SPARSE)
+    uint32_t changeCount = 0;  // number of set() / loadDefault() calls (wraps around)
+    bool deferNotify = false;  // notifications are held until dispatchChanges()
+    bool muteNotify = false;   // notifications are held while initialize() settles the values
+    size_t deferredCount = 0;  // number of parameters holding a deferred notification
+    template<typename, typename> friend class Parameter;  // for all Parameter<> classes
+    template <size_t, typename...> friend class LayoutOf;
+    friend class BlobParameter;
+    friend class FlashParam;
+    friend class ReadFromFlashVisitor;
+    friend class MapToFlashVisitor;
+    friend class WriteReserveVisitor;
+};
+
+//=================================
+// Interface of Parameter<FixedString<N>> class
+//=================================
+template <size_t N>
+class Parameter<FixedString<N>> : public BlobParameter {
+    using valueType = FixedString<N>;
+public:
+    // parameter of the default partition
+    Parameter(const LayoutItem<valueType>& item, const char* name, const valueType& defaultValue) : Parameter(Params::instance(), item, name, defaultValue) {};
+    Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size = N)
+        : Parameter(Params::instance(), id, name, flashAddr, defaultValue, size) {};
+    Parameter(const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size = N)
+        : Parameter(Params::instance(), id, name, defaultValue, size) {};
+    // parameter of the partition of params (FlashParam::params of the class constructed with UserFlashRegion)
+    Parameter(Params& params, const LayoutItem<valueType>& item, const char* name, const valueType& defaultValue)
+        : Parameter(params, item.id, name, item.flashAddr, defaultValue, item.size) { _useLayout(item.mapHash); };
+    Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue, const size_t& size = N)
+        : BlobParameter(params, id, name, flashAddr, (size < N) ? size : N, reinterpret_cast<uint8_t*>(&value), reinterpret_cast<const uint8_t*>(&this->defaultValue),
+                        sizeof(valueType), &TypeTag, HashTypeIndex<valueType>::value),
+          defaultValue(defaultValue) {};
+    Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue, const size_t& size = N)
+        : Parameter(params, id, name, params.getNextFlashAddr(), defaultValue, size) {};
+    void set(const valueType& value_) { _beginWrite(); value = value_; _useRamValue(); _endWrite(); _notifyChange(); }
+    const valueType& get() const { _fetch(); return value; }
+    // copy of the value, which is consistent even if called from the other core while set() (FLASH_PARAM_MULTICORE_SAFE)
+    valueType load() const {
+#if FLASH_PARAM_MULTICORE_SAFE
+        valueType copy;
+        seqLock.read([this, &copy]() { copy = value; });
+        return copy;
+#else
+        return get();
+#endif
+    }
+    void loadDefault() { _beginWrite(); value = defaultValue; _useRamValue(); _endWrite(); _notifyChange(); }
+    const valueType& getDefault() const { return defaultValue; }
+    const valueType& getFromFlash();
+    // observer is called on set(), loadDefault() and initialize()
+    void subscribe(ChangeObserver& observer) { Params::link(observers, observer); }
+    void unsubscribe(ChangeObserver& observer) { Params::unlink(observers, observer); }
+private:
+    static constexpr char TypeTag = 0;
+    void printValue() const override { printf("0x%04x %s: %s\n", flashAddr, name, get().c_str()); }
+    const valueType defaultValue;
+    valueType value = defaultValue;
+    friend class Params;
+    friend class FlashParam;
+};
+
+//=================================
+// Interface of Parameter<Counter<N>> class
+//=================================
+// monotonic counter (e.g. run hours or power cycles) whose increment only clears a bit on flash,
+// then finalize() programs the page in place without erase until N * 8 increments (fixed mode)
+template <size_t N>
+class Parameter<Counter<N>> : public BlobParameter {
+    using valueType = Counter<N>;
+public:
+    // parameter of the default partition
+    Parameter(const LayoutItem<valueType>& item, const char* name, const uint32_t& defaultValue) : Parameter(Params::instance(), item, name, defaultValue) {};
+    Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const uint32_t& defaultValue)
+        : Parameter(Params::instance(), id, name, flashAddr, defaultValue) {};
+    Parameter(const uint32_t& id, const char* name, const uint32_t& defaultValue) : Parameter(Params::instance(), id, name, defaultValue) {};
+    // parameter of the partition of params (FlashParam::params of the class constructed with UserFlashRegion)
+    Parameter(Params& params, const LayoutItem<valueType>& item, const char* name, const uint32_t& defaultValue)
+        : Parameter(params, item.id, name, item.flashAddr, defaultValue) { _useLayout(item.mapHash); };
+    Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const uint32_t& defaultValue)
+        : BlobParameter(params, id, name, flashAddr, sizeof(valueType), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<const uint8_t*>(&this->defaultValue),
+                        sizeof(valueType), &TypeTag, HashTypeIndex<valueType>::value),
+          defaultValue(defaultValue) {};
+    Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& defaultValue)
+        : Parameter(params, id, name, params.getNextFlashAddr(), defaultValue) {};
+    void increment() { _fetch(); _beginWrite(); value.increment(); _useRamValue(); _endWrite(); _notifyChange(); }
+    // set() compacts the value into the base, which needs erase to store
+    void set(const uint32_t& value_) { _beginWrite(); value = valueType(value_); _useRamValue(); _endWrite(); _notifyChange(); }
+    uint32_t get() const { _fetch(); return value.value(); }
+    // copy of the value, which is consistent even if called from the other core while increment() (FLASH_PARAM_MULTICORE_SAFE)
+    uint32_t load() const {
+#if FLASH_PARAM_MULTICORE_SAFE
+        valueType copy;
+        seqLock.read([this, &copy]() { copy = value; });
+        return copy.value();
+#else
+        return get();
+#endif
+    }
+    void loadDefault() { _beginWrite(); value = defaultValue; _useRamValue(); _endWrite(); _notifyChange(); }
+    uint32_t getDefault() const { return defaultValue.value(); }
+    uint32_t getLeft() const { _fetch(); return value.getLeft(); }  // increments left until compaction
+    uint32_t getFromFlash();
+    // observer is called on increment(), set(), loadDefault() and initialize()
+    void subscribe(ChangeObserver& observer) { Params::link(observers, observer); }
+    void unsubscribe(ChangeObserver& observer) { Params::unlink(observers, observer); }
+private:
+    static constexpr char TypeTag = 0;
+    void printValue() const override {
+        printf("0x%04x %s: %" PRIu32 "d (left %" PRIu32 ")\n", flashAddr, name, get(), value.getLeft());
+    }
+    const valueType defaultValue;
+    valueType value = defaultValue;
+    friend class Params;
     friend class FlashParam;
 };
 
+//=================================
+// Interface of Parameter<T> class for aggregate types
+//=================================
+// std::array<E, N> or trivially copyable struct, which is loaded and stored as a single contiguous copy
+//   set(i, element) / set(&S::member, value) update a part, and isDirty() tells the elements (the struct as a whole)
+//   changed since the last initialize() or finalize(). set() without change is not notified
+template <class T>
+class Parameter<T, std::enable_if_t<IsAggregateValue<T>::value>> : public BlobParameter {
+    using valueType = T;
+    using traits = AggregateTraits<T>;
+public:
+    static constexpr size_t NumElements = traits::numElements;
+    // parameter of the default partition
+    Parameter(const LayoutItem<valueType>& item, const char* name, const valueType& defaultValue) : Parameter(Params::instance(), item, name, defaultValue) {};
+    Parameter(const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue)
+        : Parameter(Params::instance(), id, name, flashAddr, defaultValue) {};
+    Parameter(const uint32_t& id, const char* name, const valueType& defaultValue) : Parameter(Params::instance(), id, name, defaultValue) {};
+    // parameter of the partition of params (FlashParam::params of the class constructed with UserFlashRegion)
+    Parameter(Params& params, const LayoutItem<valueType>& item, const char* name, const valueType& defaultValue)
+        : Parameter(params, item.id, name, item.flashAddr, defaultValue) { _useLayout(item.mapHash); };
+    Parameter(Params& params, const uint32_t& id, const char* name, const uint32_t& flashAddr, const valueType& defaultValue)
+        : BlobParameter(params, id, name, flashAddr, sizeof(valueType), reinterpret_cast<uint8_t*>(&value), reinterpret_cast<const uint8_t*>(&this->defaultValue),
+                        sizeof(valueType), &TypeTag, HashTypeIndex<valueType>::value),
+          defaultValue(defaultValue) {};
+    Parameter(Params& params, const uint32_t& id, const char* name, const valueType& defaultValue)
+        : Parameter(params, id, name, params.getNextFlashAddr(), defaultValue) {};
+    void set(const valueType& value_) {
+        _fetch();
+        bool changed = false;
+        for (size_t i = 0; i < NumElements; i++) {
+            if (std::memcmp(_elementOf(value, i), _elementOf(value_, i), ElementSize) != 0) {
+                _setDirty(i);
+                changed = true;
+            }
+        }
+        if (!changed) { return; }
+        _beginWrite(); value = value_; _useRamValue(); _endWrite(); _notifyChange();
+    }
+    template <typename U = T, std::enable_if_t<AggregateTraits<U>::isArray, int> = 0>
+    void set(const size_t& i, const typename AggregateTraits<U>::elementType& element) {
+        _fetch();
+        if (std::memcmp(&value.at(i), &element, ElementSize) == 0) { return; }
+        _beginWrite(); value[i] = element; _useRamValue(); _endWrite();
+        _setDirty(i);
+        _notifyChange();
+    }
+    template <typename M, typename U = T, std::enable_if_t<!AggregateTraits<U>::isArray, int> = 0>
+    void set(M U::* member, const std::remove_reference_t<M>& memberValue) {
+        _fetch();
+        if (std::memcmp(&(value.*member), &memberValue, sizeof(M)) == 0) { return; }
+        _beginWrite(); value.*member = memberValue; _useRamValue(); _endWrite();
+        _setDirty(0);
+        _notifyChange();
+    }
+    const valueType& get() const { _fetch(); return value; }
+    template <typename U = T, std::enable_if_t<AggregateTraits<U>::isArray, int> = 0>
+    const typename AggregateTraits<U>::elementType& get(const size_t& i) const { return get().at(i); }
+    // copy of the value, which is consistent even if called from the other core while set() (FLASH_PARAM_MULTICORE_SAFE)
+    valueType load() const {
+#if FLASH_PARAM_MULTICORE_SAFE
+        valueType copy;
+        seqLock.read([this, &copy]() { copy = value; });
+        return copy;
+#else
+        return get();
+#endif
+    }
+    void loadDefault() { set(defaultValue); }
+    const valueType& getDefault() const { return defaultValue; }
+    const valueType& getFromFlash();
+    bool isDirty() const {
+        for (const auto& word : dirty) {
+            if (word != 0) { return true; }
+        }
+        return false;
+    }
+    bool isDirty(const size_t& i) const { return ((dirty.at(i / 32) >> (i % 32)) & 1) != 0; }
+    // observer is called on set(), loadDefault() and initialize()
+    void subscribe(ChangeObserver& observer) { Params::link(observers, observer); }
+    void unsubscribe(ChangeObserver& observer) { Params::unlink(observers, observer); }
+private:
+    static constexpr char TypeTag = 0;
+    static constexpr size_t ElementSize = sizeof(valueType) / NumElements;
+    static const uint8_t* _elementOf(const valueType& v, const size_t& i) { return reinterpret_cast<const uint8_t*>(&v) + i * ElementSize; }
+    void _setDirty(const size_t& i) { dirty[i / 32] |= 1UL << (i % 32); }
+    void _markDirty() override { dirty.fill(0xffffffffUL); }
+    void _clearDirty() override { dirty.fill(0); }
+    void printValue() const override {
+        printf("0x%04x %s:", flashAddr, name);
+        if constexpr (traits::isArray && std::is_arithmetic_v<typename traits::elementType>) {
+            for (const auto& element : get()) {
+                if constexpr (std::is_floating_point_v<typename traits::elementType>) {
+                    printf(" %7.4f", static_cast<double>(element));
+                } else if constexpr (std::is_signed_v<typename traits::elementType>) {
+                    printf(" %lld", static_cast<long long>(element));
+                } else {
+                    printf(" %llu", static_cast<unsigned long long>(element));
+                }
+            }
+        } else {
+            const auto bytes = reinterpret_cast<const uint8_t*>(&get());
+            for (size_t i = 0; i < sizeof(valueType); i++) { printf(" %02x", bytes[i]); }
+        }
+        printf("\n");
+    }
+    const valueType defaultValue;
+    valueType value = defaultValue;
+    std::array<uint32_t, (NumElements + 31) / 32> dirty = {};  // bit per element
+    friend class Params;
+    friend class FlashParam;
+};
+
+//=================================
+// Interface of Visitors
+//=================================
+// flash access goes to UserFlash of the partition which each parameter belongs to
+struct ReadFromFlashVisitor {
+    static constexpr uint32_t OwnFlashAddr = 0xffffffffUL;
+    uint32_t flashAddr = OwnFlashAddr;  // e.g. the address in the image of the other schema, otherwise that of the parameter
+    template <typename T>
+    void operator()(const T& param) const {
+        const uint32_t addr = (flashAddr == OwnFlashAddr) ? param->params.flashAddrOf(param) : flashAddr;
+        param->_beginWrite();
+        if (addr != Params::NoFlashAddr) {
+            param->params.getUserFlash().read(addr, param->size, param->value);
+        } else {
+            param->value = param->defaultValue;  // not stored since the value equals default (FLASH_PARAM_SPARSE)
+        }
+        param->_useRamValue();
+        param->_endWrite();
+    }
+    void operator()(BlobParameter* param) const {
+        const uint32_t addr = (flashAddr == OwnFlashAddr) ? param->params.flashAddrOf(param) : flashAddr;
+        param->_beginWrite();
+        if (addr != Params::NoFlashAddr) {
+            param->params.getUserFlash().readBytes(addr, param->size, param->valuePtr);
+            param->_clearTail();
+        } else {
+            std::memcpy(param->valuePtr, param->defaultPtr, param->valueSize);  // not stored since the value equals default (FLASH_PARAM_SPARSE)
+        }
+        param->_useRamValue();
+        param->_endWrite();
+    }
+};
+
+#if FLASH_PARAM_XIP_READ
+// refer to the value on XIP-mapped flash instead of copying if possible
+struct MapToFlashVisitor {
+    bool readIfNotMapped = true;
+    template <typename T>
+    void operator()(const T& param) const {
+        using valueType = std::remove_const_t<std::remove_reference_t<decltype(param->value)>>;
+        const auto ptr = param->params.getUserFlash().template getMappedAddr<valueType>(param->flashAddr, param->size);
+        if (ptr != nullptr) {
+            param->_beginWrite();
+            param->ref = ptr;
+#if FLASH_PARAM_LAZY_LOAD
+            param->pending = false;
+#endif
+            param->_endWrite();
+        } else if (readIfNotMapped) {
+            ReadFromFlashVisitor{}(param);
+        }
+    }
+    void operator()(BlobParameter* param) const {
+        if (readIfNotMapped) {
+            ReadFromFlashVisitor{}(param);
+        }
+    }
+};
+#endif
+
+struct WriteReserveVisitor {
+    static constexpr uint32_t OwnFlashAddr = 0xffffffffUL;
+    uint32_t flashAddr = OwnFlashAddr;  // e.g. the address in the record (FLASH_PARAM_SPARSE), otherwise that of the parameter
+    template <typename T>
+    void operator()(const T& param) const {
+        if (flashAddr == OwnFlashAddr) {
+#if FLASH_PARAM_LAZY_LOAD
+            if (param->pending) { return; }  // not loaded yet, then the image already holds the value
+#endif
+            param->params.getUserFlash().writeReserve(param->flashAddr, param->size, param->get());
+        } else {
+            param->params.getUserFlash().writeReserve(flashAddr, param->size, param->get());
+        }
+    }
+    void operator()(BlobParameter* param) const {
+        if (flashAddr == OwnFlashAddr) {
+#if FLASH_PARAM_LAZY_LOAD
+            if (param->pending) { return; }  // not loaded yet, then the image already holds the value
+#endif
+            param->params.getUserFlash().writeReserveBytes(param->flashAddr, param->size, param->valuePtr);
+        } else {
+            param->_fetch();
+            param->params.getUserFlash().writeReserveBytes(flashAddr, param->size, param->valuePtr);
+        }
+    }
+};
+
+struct PrintInfoVisitor {
+    void operator()(const Parameter<bool>* param) const { printf("0x%04x %s: %s\n", param->flashAddr, param->name, param->get() ? "true" : "false"); }
+    void operator()(const Parameter<uint8_t>* param) const { printf("0x%04x %s: %" PRIu8 "d (0x%" PRIx8 ")\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<uint16_t>* param) const { printf("0x%04x %s: %" PRIu16 "d (0x%" PRIx16 ")\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<uint32_t>* param) const { printf("0x%04x %s: %" PRIu32 "d (0x%" PRIx32 ")\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<uint64_t>* param) const { printf("0x%04x %s: %" PRIu64 "d (0x%" PRIx64 ")\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<int8_t>* param) const { printf("0x%04x %s: %" PRIi8 "d (0x%" PRIx8 ")\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<int16_t>* param) const { printf("0x%04x %s: %" PRIi16 "d (0x%" PRIx16 ")\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<int32_t>* param) const { printf("0x%04x %s: %" PRIi32 "d (0x%" PRIx32 ")\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<int64_t>* param) const { printf("0x%04x %s: %" PRIi64 "d (0x%" PRIx64 ")\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<float>* param) const { printf("0x%04x %s: %7.4f (%7.4e)\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<double>* param) const { printf("0x%04x %s: %7.4f (%7.4e)\n", param->flashAddr, param->name, param->get(), param->get()); }
+    void operator()(const Parameter<std::string>* param) const { printf("0x%04x %s: %s\n", param->flashAddr, param->name, param->get().c_str()); }
+    void operator()(const BlobParameter* param) const { param->printValue(); }
+};
+
+template <class T, class Enable>
+void Parameter<T, Enable>::subscribe(ChangeObserver& observer)
+{
+    Params::link(observers, observer);
+}
+
+template <class T, class Enable>
+void Parameter<T, Enable>::unsubscribe(ChangeObserver& observer)
+{
+    Params::unlink(observers, observer);
+}
+
+template <class T, class Enable>
+void Parameter<T, Enable>::_notifyChange()
+{
+    params.changeCount++;
+    params.notifyChange(id, observers, notifyPending);
+}
+
+template <class T, class Enable>
+Params& Parameter<T, Enable>::_defaultParams()
+{
+    return Params::instance();
+}
+
+template <class T, class Enable>
+void Parameter<T, Enable>::_useLayout(const uint32_t& mapHash)
+{
+    params.useLayout(mapHash);
+}
+
+#if FLASH_PARAM_LAZY_LOAD
+//=================================
+// Implementation of lazy loading
+//=================================
+template <class T, class Enable>
+void Parameter<T, Enable>::_fetchFromFlash() const
+{
+    // the value is cached on the first access even through const accessor
+    auto self = const_cast<Parameter*>(this);
+#if FLASH_PARAM_XIP_READ
+    MapToFlashVisitor{}(self);
+#else
+    ReadFromFlashVisitor{}(self);
+#endif
+    params.loadCount++;
+}
+#endif
+
+//=================================
+// Implementation of Parameter<FixedString<N>> class
+//=================================
+template <size_t N>
+const typename Parameter<FixedString<N>>::valueType& Parameter<FixedString<N>>::getFromFlash()
+{
+    ReadFromFlashVisitor visitor;
+    visitor(static_cast<BlobParameter*>(this));
+    return value;
+}
+
+//=================================
+// Implementation of Parameter<Counter<N>> class
+//=================================
+template <size_t N>
+uint32_t Parameter<Counter<N>>::getFromFlash()
+{
+    ReadFromFlashVisitor visitor;
+    visitor(static_cast<BlobParameter*>(this));
+    return value.value();
+}
+
+//=================================
+// Implementation of Parameter<T> class for aggregate types
+//=================================
+template <class T>
+const typename Parameter<T, std::enable_if_t<IsAggregateValue<T>::value>>::valueType& Parameter<T, std::enable_if_t<IsAggregateValue<T>::value>>::getFromFlash()
+{
+    ReadFromFlashVisitor visitor;
+    visitor(static_cast<BlobParameter*>(this));
+    return value;
+}
+
 //=================================
 // Interface of FlashParam class
 //=================================
@@ -137,39 +942,162 @@ typedef enum {
     CFG_ID_BASE
 } ParamIdBase_t;
 
+// conditions to commit pending changes by serviceAutoCommit()
+struct AutoCommitConfig {
+    uint32_t quietMs = 1000;     // commit when no change has been made for this period
+    uint32_t maxDelayMs = 10000; // commit at latest this period after the first pending change (0: no limit)
+    uint32_t maxPending = 0;     // commit when the number of pending changes reaches this (0: no limit)
+    bool async = false;          // commit by finalizeAsync() instead of finalize()
+};
+
+struct AutoCommitStats {
+    uint32_t changes = 0;        // changes coalesced into commits
+    uint32_t commits = 0;        // commits requested by serviceAutoCommit()
+    uint32_t byQuiet = 0;
+    uint32_t byMaxDelay = 0;
+    uint32_t byMaxPending = 0;
+    uint32_t failures = 0;
+    uint32_t getSaved() const { return changes - commits; }  // commits saved against finalize() per change
+};
+
 class FlashParam
 {
 public:
     virtual void initialize(bool preserveStoreCount = false);
     virtual bool finalize();
+    // request to store without blocking. serviceFinalize() needs to be called from background context to complete
+    virtual void finalizeAsync(commit_callback_t callback = nullptr, void* context = nullptr);
+    bool serviceFinalize();
+    bool isFinalizing() const;
+    CommitResult_t getFinalizeResult() const;
+    // debounced commit: serviceAutoCommit() is to be called periodically from the context calling set()
+    void enableAutoCommit(const AutoCommitConfig& config = AutoCommitConfig());
+    void disableAutoCommit() { autoCommitEnabled = false; }
+    bool serviceAutoCommit(const uint32_t& nowMs);
+    uint32_t getPendingChanges() const { return params.getChangeCount() - committedChangeCount; }
+    const AutoCommitStats& getAutoCommitStats() const { return autoCommitStats; }
+    // change notification by id: observer is called on set(), loadDefault() and initialize() of the parameter
+    void subscribe(const uint32_t& id, ChangeObserver& observer) { params.subscribe(id, observer); }
+    void unsubscribe(const uint32_t& id, ChangeObserver& observer) { params.unsubscribe(id, observer); }
+    // deferred: notifications are batched per parameter until dispatchChanges(), otherwise called inside set()
+    void setDeferredNotify(bool deferred);
+    size_t dispatchChanges() { return params.dispatchChanges(); }
+    size_t getDeferredChanges() const { return params.deferredCount; }
+    // streaming export / import of the parameters except for the built-in parameters, chunk by chunk through the callback
+    //   import validates type and size per id, then sets the value as set() does (finalize() is needed to store)
+    bool exportTo(const StreamFormat_t& format, export_sink_t sink, void* context = nullptr) const { return params.exportTo(format, sink, context); }
+    ImportResult importFrom(const StreamFormat_t& format, import_source_t source, void* context = nullptr) { return params.importFrom(format, source, context); }
     virtual void loadDefault(bool preserveStoreCount = false);
     virtual void printInfo() const;
     // accessor by id on template T = primitive type
     template <typename T>
     decltype(auto) getValue(const uint32_t& id) const { return _getValue<Parameter<T>>(id); }
     template <typename T>
+    T loadValue(const uint32_t& id) const { return params.getParam<Parameter<T>>(id).load(); }
+    template <typename T>
     void setValue(const uint32_t& id, const T& value) { _setValue<Parameter<T>>(id, value); }
+    // accessor by name on template T = primitive type, resolved in constant time by the index of setNameIndex()
+    //   unknown name aborts as unknown id does. findId() is to check the name beforehand
+    template <size_t N>
+    void setNameIndex(const NameIndex<N>& index);
+    bool findId(const std::string_view& name, uint32_t& id) const { return nameFind != nullptr && nameFind(nameIndex, name, id); }
+    template <typename T>
+    decltype(auto) getValue(const std::string_view& name) const { return _getValue<Parameter<T>>(_idOf(name)); }
+    template <typename T>
+    T loadValue(const std::string_view& name) const { return params.getParam<Parameter<T>>(_idOf(name)).load(); }
+    template <typename T>
+    void setValue(const std::string_view& name, const T& value) { _setValue<Parameter<T>>(_idOf(name), value); }
+    // number of parameters loaded from flash since initialize()
+    size_t getLoadCount() const { return params.getLoadCount(); }
+    // counters and latency histograms of initialize() and flash operations on RAM (erase counts per sector are UserFlash::getEraseCount())
+    FlashStats getFlashStats() const { return userFlash.getStats(); }
+    void resetFlashStats() { userFlash.resetStats(); }
+    // number of parameters whose values are kept by initialize() when CFG_MAP_HASH is changed (FLASH_PARAM_MIGRATION)
+    size_t getMigrateCount() const { return params.getMigrateCount(); }
 
 protected:
-    FlashParam() = default;
+    FlashParam();  // default partition (FLASH_PARAM_SIZE, FLASH_PARAM_OFFSET and FLASH_PARAM_RING_SECTORS)
+    explicit FlashParam(const UserFlashRegion& region);  // partition with its own region
     ~FlashParam() = default;
     FlashParam(const FlashParam&) = delete;
     FlashParam& operator=(const FlashParam&) = delete;
     // accessor by uint32_t on template T = Patameter<>
     template <typename T>
     void _setValue(const uint32_t& id, const typename T::valueType& value) {
-        auto& param = Params::instance().getParam<T>(id);
+        auto& param = params.getParam<T>(id);
         return param.set(value);
     }
     template <typename T>
     decltype(auto) _getValue(const uint32_t& id) const {
-        const auto& param = Params::instance().getParam<T>(id);
+        const auto& param = params.getParam<T>(id);
         return param.get();
     }
 
+    uint32_t _idOf(const std::string_view& name) const {
+        uint32_t id;
+        if (!findId(name, id)) { std::abort(); }  // unknown name
+        return id;
+    }
+
+    void _loadValues(bool preserveStoreCount);
+    // set only if it differs, which is neither notified nor counted as a change on every commit
+    void _updateMapHash() {
+        if (P_CFG_MAP_HASH.get() != params.getMapHash()) { P_CFG_MAP_HASH.set(params.getMapHash()); }
+    }
+    // CFG_STORE_COUNT in the image is the base, which is counted up by store ticks on flash (see UserFlash::getStoreTicks())
+    void _reserveStoreBase() {
+        userFlash.writeReserve(P_CFG_STORE_COUNT.flashAddr, sizeof(uint32_t), P_CFG_STORE_COUNT.get() - static_cast<uint32_t>(userFlash.getStoreTicks()));
+    }
+    bool _countUpStore(bool inPlaceAware);
+    bool _settleAsync();
+
+    void _markCommitted() {
+        committedChangeCount = params.getChangeCount();
+        observedChangeCount = committedChangeCount;
+        asyncPending = false;
+        params.clearDirty();
+    }
+
+    // partition: members below are constructed in this order, then parameters of derived class are added to params
+    //   parameters of the partition constructed with UserFlashRegion are constructed with params (see Parameter<T>)
+    std::unique_ptr<UserFlash> ownedUserFlash;  // nullptr for the default partition
+    std::unique_ptr<Params> ownedParams;
+    UserFlash& userFlash;
+    Params& params;
+
+    // auto commit
+    bool autoCommitEnabled = false;
+    AutoCommitConfig autoCommitConfig;
+    AutoCommitStats autoCommitStats;
+    uint32_t committedChangeCount = 0;  // changeCount at the last commit
+    uint32_t observedChangeCount = 0;   // changeCount seen by the last serviceAutoCommit()
+    bool asyncPending = false;          // result of finalizeAsync() is not settled yet
+    uint32_t asyncChangeCount = 0;      // changeCount at finalizeAsync()
+    uint32_t asyncStoreCount = 0;       // CFG_STORE_COUNT before finalizeAsync(), which is restored if it fails
+    uint32_t* asyncReason = nullptr;    // counter of autoCommitStats if requested by serviceAutoCommit()
+    uint32_t asyncChanges = 0;          // pending changes requested by serviceAutoCommit()
+    uint32_t firstChangeMs = 0;
+    uint32_t lastChangeMs = 0;
+
+    // name index (setNameIndex())
+    const void* nameIndex = nullptr;
+    bool (*nameFind)(const void* index, const std::string_view& name, uint32_t& id) = nullptr;
+
     // built-in parameters
     // Parameter<T>        instance          id                name              default
-    Parameter<uint32_t>    P_CFG_MAP_HASH   {CFG_MAP_HASH,    "CFG_MAP_HASH",    0};
-    Parameter<uint32_t>    P_CFG_STORE_COUNT{CFG_STORE_COUNT, "CFG_STORE_COUNT", 0};
+    Parameter<uint32_t>    P_CFG_MAP_HASH   {params, CFG_MAP_HASH,    "CFG_MAP_HASH",    0};
+    Parameter<uint32_t>    P_CFG_STORE_COUNT{params, CFG_STORE_COUNT, "CFG_STORE_COUNT", 0};
 };
+
+// the index is to be kept alive (e.g. static constexpr member of the derived class),
+// and each entry is checked to have the same name as the parameter of its id
+template <size_t N>
+void FlashParam::setNameIndex(const NameIndex<N>& index)
+{
+    for (size_t i = 0; i < N; i++) {
+        if (params.nameOf(index[i].id) != index[i].name) { std::abort(); }  // the index doesn't match the parameters
+    }
+    nameIndex = &index;
+    nameFind = NameIndex<N>::findIn;
+}
 }
@@ -0,0 +1,491 @@
+/*-----------------------------------------------------------/
+/ FlashParamStream.cpp
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "FlashParam.h"
+
+namespace FlashParamNs {
+
+namespace {
+//=================================
+// Stream helpers
+//=================================
+// buffered writer to the sink of export
+class StreamWriter
+{
+public:
+    StreamWriter(export_sink_t sink, void* context) : sink(sink), context(context) {}
+    void write(const void* data, size_t size) {
+        auto ptr = static_cast<const uint8_t*>(data);
+        while (size > 0 && ok) {
+            const size_t n = std::min(size, ChunkSize - pos);
+            std::memcpy(buf + pos, ptr, n);
+            pos += n;
+            ptr += n;
+            size -= n;
+            if (pos == ChunkSize) { flush(); }
+        }
+    }
+    void fill(const uint8_t& value, size_t size) {
+        while (size > 0 && ok) {
+            const size_t n = std::min(size, ChunkSize - pos);
+            std::memset(buf + pos, value, n);
+            pos += n;
+            size -= n;
+            if (pos == ChunkSize) { flush(); }
+        }
+    }
+    void put(const char& c) { write(&c, 1); }
+    void print(const char* str) { write(str, std::strlen(str)); }
+    bool flush() {
+        if (ok && pos > 0) { ok = sink(buf, pos, context); }
+        pos = 0;
+        return ok;
+    }
+private:
+    static constexpr size_t ChunkSize = 64;
+    export_sink_t sink;
+    void* context;
+    uint8_t buf[ChunkSize];
+    size_t pos = 0;
+    bool ok = true;
+};
+
+// buffered reader from the source of import
+class StreamReader
+{
+public:
+    static constexpr int End = -1;
+    StreamReader(import_source_t source, void* context) : source(source), context(context) {}
+    int peek() {
+        if (pos == len && !_fill()) { return End; }
+        return buf[pos];
+    }
+    int get() {
+        const int c = peek();
+        if (c != End) { pos++; }
+        return c;
+    }
+    bool read(void* data, size_t size) {
+        auto ptr = static_cast<uint8_t*>(data);
+        while (size > 0) {
+            if (pos == len && !_fill()) { return false; }
+            const size_t n = std::min(size, len - pos);
+            if (ptr != nullptr) {
+                std::memcpy(ptr, buf + pos, n);
+                ptr += n;
+            }
+            pos += n;
+            size -= n;
+        }
+        return true;
+    }
+    bool skip(const size_t& size) { return read(nullptr, size); }
+    void skipLine() {
+        for (int c = get(); c != '\n' && c != End; c = get()) {}
+    }
+private:
+    static constexpr size_t ChunkSize = 64;
+    bool _fill() {
+        len = std::min(source(buf, ChunkSize, context), ChunkSize);
+        pos = 0;
+        return len > 0;
+    }
+    import_source_t source;
+    void* context;
+    uint8_t buf[ChunkSize];
+    size_t pos = 0;
+    size_t len = 0;
+};
+
+// type names of the text format indexed by type index (see HashTypeIndex)
+constexpr const char* TypeNames[] = {"bool", "u8", "u16", "u32", "u64", "i8", "i16", "i32", "i64", "f32", "f64", "str", "hex"};
+static_assert(sizeof(TypeNames) / sizeof(TypeNames[0]) == std::variant_size_v<variant_t>, "type name is missing");
+constexpr size_t StringTypeIndex = HashTypeIndex<std::string>::value;
+
+int _hexDigit(const int& c)
+{
+    if (c >= '0' && c <= '9') { return c - '0'; }
+    if (c >= 'a' && c <= 'f') { return c - 'a' + 10; }
+    if (c >= 'A' && c <= 'F') { return c - 'A' + 10; }
+    return -1;
+}
+
+// string until '\0' with escape of '\\', control and non-ASCII characters
+void _printEscaped(StreamWriter& writer, const uint8_t* data, const size_t& size)
+{
+    for (size_t i = 0; i < size && data[i] != '\0'; i++) {
+        const uint8_t c = data[i];
+        if (c == '\\') {
+            writer.print("\\\\");
+        } else if (c == '\n') {
+            writer.print("\\n");
+        } else if (c == '\r') {
+            writer.print("\\r");
+        } else if (c == '\t') {
+            writer.print("\\t");
+        } else if (c < 0x20 || c >= 0x7f) {
+            char hex[5];
+            snprintf(hex, sizeof(hex), "\\x%02x", c);
+            writer.print(hex);
+        } else {
+            writer.put(static_cast<char>(c));
+        }
+    }
+}
+
+void _printHex(StreamWriter& writer, const uint8_t* data, const size_t& size)
+{
+    for (size_t i = 0; i < size; i++) {
+        char hex[3];
+        snprintf(hex, sizeof(hex), "%02x", data[i]);
+        writer.print(hex);
+    }
+}
+
+template <typename T>
+void _printNumber(StreamWriter& writer, const T& value)
+{
+    char text[32];
+    if constexpr (std::is_same_v<T, bool>) {
+        snprintf(text, sizeof(text), "%s", value ? "true" : "false");
+    } else if constexpr (std::is_same_v<T, float>) {
+        snprintf(text, sizeof(text), "%.9g", value);  // digits to restore the same value
+    } else if constexpr (std::is_same_v<T, double>) {
+        snprintf(text, sizeof(text), "%.17g", value);
+    } else if constexpr (std::is_signed_v<T>) {
+        snprintf(text, sizeof(text), "%lld", static_cast<long long>(value));
+    } else {
+        snprintf(text, sizeof(text), "%llu", static_cast<unsigned long long>(value));
+    }
+    writer.print(text);
+}
+
+// the rest of the line into size bytes padded with '\0', where the line is consumed even if it fails
+bool _readEscaped(StreamReader& reader, uint8_t* data, const size_t& size)
+{
+    std::fill(data, data + size, 0);
+    size_t n = 0;
+    bool ok = true;
+    for (int c = reader.get(); c != '\n' && c != StreamReader::End; c = reader.get()) {
+        if (c == '\r') { continue; }  // CRLF
+        if (c == '\\') {
+            const int e = reader.peek();
+            if (e == '\n' || e == StreamReader::End) { return false; }
+            reader.get();
+            if (e == 'n') {
+                c = '\n';
+            } else if (e == 'r') {
+                c = '\r';
+            } else if (e == 't') {
+                c = '\t';
+            } else if (e == '\\') {
+                c = '\\';
+            } else if (e == 'x') {
+                const int h = _hexDigit(reader.peek());
+                if (h >= 0) { reader.get(); }
+                const int l = _hexDigit(reader.peek());
+                if (l >= 0) { reader.get(); }
+                if (h < 0 || l < 0) { ok = false; }
+                c = h * 16 + l;
+            } else {
+                ok = false;
+            }
+        }
+        if (n < size) {
+            data[n++] = static_cast<uint8_t>(c);
+        } else {
+            ok = false;  // exceeds the size
+        }
+    }
+    return ok;
+}
+
+// the rest of the line as hex digits of exactly size bytes, where the line is consumed even if it fails
+bool _readHex(StreamReader& reader, uint8_t* data, const size_t& size)
+{
+    size_t n = 0;
+    bool ok = true;
+    for (int c = reader.get(); c != '\n' && c != StreamReader::End; c = reader.get()) {
+        if (c == '\r' || c == ' ') { continue; }
+        const int digit = _hexDigit(c);
+        if (digit < 0 || n >= size * 2) {
+            ok = false;
+            continue;
+        }
+        data[n / 2] = static_cast<uint8_t>((n % 2 == 0) ? (digit << 4) : (data[n / 2] | digit));
+        n++;
+    }
+    return ok && n == size * 2;
+}
+
+// a field separated by space, which returns the delimiter ('\n' or StreamReader::End at the end of line)
+//   field is empty if it exceeds the capacity
+int _readField(StreamReader& reader, char* field, const size_t& capacity)
+{
+    while (reader.peek() == ' ' || reader.peek() == '\t') { reader.get(); }
+    size_t n = 0;
+    bool overflow = false;
+    int c;
+    for (c = reader.get(); c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != StreamReader::End; c = reader.get()) {
+        if (n + 1 < capacity) {
+            field[n++] = static_cast<char>(c);
+        } else {
+            overflow = true;
+        }
+    }
+    field[overflow ? 0 : n] = '\0';
+    if (c == '\r' && reader.peek() == '\n') { c = reader.get(); }
+    return c;
+}
+
+// decimal number as exported (a leading 0 is not octal), where the value out of range of unsigned long long is rejected
+bool _parseUnsigned(const char* text, unsigned long long& value)
+{
+    char* end;
+    if (text[0] == '\0' || text[0] == '-') { return false; }
+    errno = 0;
+    value = strtoull(text, &end, 10);
+    return *end == '\0' && errno != ERANGE;
+}
+
+template <typename T>
+bool _parseNumber(const char* text, uint8_t* data)
+{
+    T value;
+    char* end = nullptr;
+    if (text[0] == '\0') { return false; }
+    if constexpr (std::is_same_v<T, bool>) {
+        if (std::strcmp(text, "true") == 0 || std::strcmp(text, "1") == 0) {
+            value = true;
+        } else if (std::strcmp(text, "false") == 0 || std::strcmp(text, "0") == 0) {
+            value = false;
+        } else {
+            return false;
+        }
+    } else if constexpr (std::is_floating_point_v<T>) {
+        value = static_cast<T>(strtod(text, &end));
+        if (*end != '\0') { return false; }
+    } else if constexpr (std::is_signed_v<T>) {
+        errno = 0;
+        const long long v = strtoll(text, &end, 10);
+        if (*end != '\0' || errno == ERANGE || v < std::numeric_limits<T>::min() || v > std::numeric_limits<T>::max()) { return false; }
+        value = static_cast<T>(v);
+    } else {
+        unsigned long long v;
+        if (!_parseUnsigned(text, v) || v > std::numeric_limits<T>::max()) { return false; }
+        value = static_cast<T>(v);
+    }
+    std::memcpy(data, &value, sizeof(T));
+    return true;
+}
+}
+
+//=================================
+// Implementation of streaming export / import of Params class
+//=================================
+bool Params::exportTo(const StreamFormat_t& format, export_sink_t sink, void* context) const
+{
+    StreamWriter writer(sink, context);
+    if (format == STREAM_BINARY) {
+        const StreamHeader header = {StreamMagic, mapHash};
+        writer.write(&header, sizeof(header));
+    } else {
+        writer.print("# pico_flash_param ");
+        writer.print(userFlash.getName());
+        writer.put('\n');
+    }
+    // the value in the flash format (size bytes)
+    const auto writeBytes = [&writer](auto&& param) {
+        using P = std::remove_pointer_t<std::decay_t<decltype(param)>>;
+        if constexpr (std::is_same_v<P, BlobParameter>) {
+            param->_fetch();
+            writer.write(param->valuePtr, param->size);
+        } else {
+            const auto& value = param->get();
+            size_t len;
+            if constexpr (std::is_same_v<typename P::valueType, std::string>) {
+                len = std::min(value.size(), param->size);
+                writer.write(value.data(), len);
+            } else {
+                len = std::min(sizeof(value), param->size);
+                writer.write(&value, len);
+            }
+            writer.fill(0, param->size - len);
+        }
+    };
+    const auto printValue = [&writer](auto&& param) {
+        using P = std::remove_pointer_t<std::decay_t<decltype(param)>>;
+        if constexpr (std::is_same_v<P, BlobParameter>) {
+            param->_fetch();
+            if (param->hashTypeIndex == StringTypeIndex) {
+                _printEscaped(writer, param->valuePtr, param->size);
+            } else {
+                _printHex(writer, param->valuePtr, param->size);
+            }
+        } else if constexpr (std::is_same_v<typename P::valueType, std::string>) {
+            const auto& value = param->get();
+            _printEscaped(writer, reinterpret_cast<const uint8_t*>(value.data()), std::min(value.size(), param->size));
+        } else {
+            _printNumber(writer, param->get());
+        }
+    };
+    forEach([&](const variant_t& item) {
+        std::visit([&](auto&& param) {
+            if (param->id < CFG_ID_BASE) { return; }  // built-in parameters are managed by the library
+            const size_t typeIndex = typeIndexOf(param);
+            if (format == STREAM_BINARY) {
+                const ParamRecord record = {
+                    static_cast<uint16_t>(param->id), static_cast<uint8_t>(typeIndex), 0xff, static_cast<uint16_t>(param->size)
+                };
+                writer.write(&record, sizeof(record));
+                writeBytes(param);
+            } else {
+                char field[32];
+                snprintf(field, sizeof(field), "%d ", static_cast<int>(param->id));
+                writer.print(field);
+                writer.print(param->name);
+                snprintf(field, sizeof(field), " %s %d ", TypeNames[typeIndex], static_cast<int>(param->size));
+                writer.print(field);
+                printValue(param);
+                writer.put('\n');
+            }
+        }, item);
+    });
+    if (format == STREAM_BINARY) {
+        const ParamRecord end = {RecordEnd, 0xff, 0xff, 0};
+        writer.write(&end, sizeof(end));
+    }
+    return writer.flush();
+}
+
+ImportResult Params::importFrom(const StreamFormat_t& format, import_source_t source, void* context)
+{
+    ImportResult result;
+    StreamReader reader(source, context);
+    // each value is applied after it's read entirely, then only the largest value is staged on RAM
+    size_t maxSize = sizeof(uint64_t);
+    forEach([&maxSize](const variant_t& item) {
+        std::visit([&maxSize](auto&& param) { maxSize = std::max(maxSize, param->size); }, item);
+    });
+    std::vector<uint8_t> staging(maxSize);
+    const auto find = [this](const uint32_t& id) -> const variant_t* {
+        if (id < CFG_ID_BASE || id >= paramTable.size()) { return nullptr; }  // built-in parameters are not imported
+        const variant_t& item = paramTable[id];
+        return std::visit([](auto&& param) { return param != nullptr; }, item) ? &item : nullptr;
+    };
+    // set the value in the flash format as set() does
+    const auto applyBytes = [](auto&& param, const uint8_t* data) {
+        using P = std::remove_pointer_t<std::decay_t<decltype(param)>>;
+        if constexpr (std::is_same_v<P, BlobParameter>) {
+            param->_beginWrite();
+            std::memcpy(param->valuePtr, data, param->size);
+            param->_clearTail();
+            param->_useRamValue();
+            param->_endWrite();
+            param->_markDirty();
+            param->_notifyChange();
+        } else if constexpr (std::is_same_v<typename P::valueType, std::string>) {
+            const auto str = reinterpret_cast<const char*>(data);
+            param->set(std::string(str, strnlen(str, param->size)));
+        } else {
+            auto value = param->get();
+            std::memcpy(&value, data, std::min(sizeof(value), param->size));
+            param->set(value);
+        }
+    };
+
+    if (format == STREAM_BINARY) {
+        StreamHeader header;
+        if (!reader.read(&header, sizeof(header)) || header.magic != StreamMagic) { return result; }
+        while (true) {
+            ParamRecord record;
+            if (!reader.read(&record, sizeof(record))) { break; }  // truncated
+            if (record.id == RecordEnd) {
+                result.complete = true;
+                break;
+            }
+            if (record.size > staging.size()) {
+                result.rejected++;
+                if (!reader.skip(record.size)) { break; }
+                continue;
+            }
+            if (!reader.read(staging.data(), record.size)) { break; }
+            const variant_t* item = find(record.id);
+            const bool applied = (item != nullptr) && std::visit([&](auto&& param) {
+                if (typeIndexOf(param) != record.typeIndex || param->size != record.size) { return false; }
+                applyBytes(param, staging.data());
+                return true;
+            }, *item);
+            applied ? result.applied++ : result.rejected++;
+        }
+        return result;
+    }
+
+    // STREAM_TEXT
+    while (true) {
+        const int c = reader.peek();
+        if (c == StreamReader::End) {
+            result.complete = true;
+            break;
+        }
+        if (c == '#' || c == '\r' || c == '\n') {  // comment or empty line
+            reader.skipLine();
+            continue;
+        }
+        char idField[12];
+        char nameField[2];  // name is for information
+        char typeField[8];
+        char sizeField[12];
+        bool applied = false;
+        // the delimiter of the last field read, which is the end of line if the line is truncated
+        int delimiter = _readField(reader, idField, sizeof(idField));
+        if (delimiter == ' ') { delimiter = _readField(reader, nameField, sizeof(nameField)); }
+        if (delimiter == ' ') { delimiter = _readField(reader, typeField, sizeof(typeField)); }
+        if (delimiter == ' ') { delimiter = _readField(reader, sizeField, sizeof(sizeField)); }
+        if (delimiter == ' ') {
+            unsigned long long id;
+            unsigned long long size;
+            const variant_t* item = (_parseUnsigned(idField, id) && id <= std::numeric_limits<uint32_t>::max()) ? find(static_cast<uint32_t>(id)) : nullptr;
+            if (item != nullptr && _parseUnsigned(sizeField, size)) {
+                applied = std::visit([&](auto&& param) {
+                    using P = std::remove_pointer_t<std::decay_t<decltype(param)>>;
+                    if (std::strcmp(typeField, TypeNames[typeIndexOf(param)]) != 0 || param->size != size) {
+                        reader.skipLine();
+                        return false;
+                    }
+                    bool decoded;
+                    if constexpr (std::is_same_v<P, BlobParameter>) {
+                        decoded = (param->hashTypeIndex == StringTypeIndex) ? _readEscaped(reader, staging.data(), param->size) : _readHex(reader, staging.data(), param->size);
+                    } else if constexpr (std::is_same_v<typename P::valueType, std::string>) {
+                        decoded = _readEscaped(reader, staging.data(), param->size);
+                    } else {
+                        char valueField[40];
+                        const int delimiter = _readField(reader, valueField, sizeof(valueField));
+                        if (delimiter != '\n' && delimiter != StreamReader::End) { reader.skipLine(); }
+                        decoded = _parseNumber<typename P::valueType>(valueField, staging.data());
+                    }
+                    if (decoded) { applyBytes(param, staging.data()); }
+                    return decoded;
+                }, *item);
+            } else {
+                reader.skipLine();
+            }
+        } else if (delimiter != '\n' && delimiter != StreamReader::End) {
+            reader.skipLine();
+        }
+        applied ? result.applied++ : result.rejected++;
+    }
+    return result;
+}
+}
@@ -0,0 +1,90 @@
+/*-----------------------------------------------------------/
+/ FlashStats.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdio>
+
+namespace FlashParamNs {
+//=================================
+// Interface of LatencyHistogram class
+//=================================
+// histogram of latency in usec by bins of power of 2 (no heap allocation)
+//   bin i holds [2^i, 2^(i+1)) usec (bin 0 also holds 0 usec), and the last bin holds the rest
+class LatencyHistogram
+{
+public:
+    static constexpr size_t NumBins = 20;  // up to about 1 sec
+    void add(const uint32_t& usec) {
+        size_t bin = 0;
+        while (bin < NumBins - 1 && (usec >> (bin + 1)) > 0) { bin++; }
+        bins[bin]++;
+        count++;
+        totalUs += usec;
+        if (usec > maxUs) { maxUs = usec; }
+    }
+    void reset() { *this = LatencyHistogram(); }
+    uint32_t getCount() const { return count; }
+    uint32_t getBin(const size_t& bin) const { return bins.at(bin); }
+    uint32_t getMaxUs() const { return maxUs; }
+    uint32_t getMeanUs() const { return (count > 0) ? static_cast<uint32_t>(totalUs / count) : 0; }
+    // upper bound of the bin which reaches percent of the samples (not beyond the max)
+    uint32_t getPercentileUs(const uint32_t& percent) const {
+        const uint64_t target = (static_cast<uint64_t>(count) * percent + 99) / 100;
+        uint64_t sum = 0;
+        for (size_t bin = 0; bin < NumBins - 1; bin++) {
+            sum += bins[bin];
+            if (sum >= target && sum > 0) {
+                const uint32_t upper = (2UL << bin) - 1;
+                return (upper < maxUs) ? upper : maxUs;
+            }
+        }
+        return maxUs;
+    }
+    void print(const char* name) const {
+        printf("%s: count %d, mean %d us, p50 %d us, p99 %d us, max %d us\r\n", name, static_cast<int>(count),
+            static_cast<int>(getMeanUs()), static_cast<int>(getPercentileUs(50)), static_cast<int>(getPercentileUs(99)), static_cast<int>(maxUs));
+    }
+private:
+    std::array<uint32_t, NumBins> bins = {};
+    uint32_t count = 0;
+    uint64_t totalUs = 0;
+    uint32_t maxUs = 0;
+};
+
+//=================================
+// Interface of FlashStats struct
+//=================================
+// counters of flash operations on RAM since boot or resetStats() (see UserFlash::getStats())
+//   updated by the context which programs under FlashBackend::lock(), then read as a copy
+struct FlashStats {
+    uint32_t commits = 0;         // program() / service() which started to program the image
+    uint32_t failures = 0;        // commits failed by safeExecute() (e.g. timeout to pause the other core)
+    uint32_t eraseSectors = 0;
+    uint64_t eraseBytes = 0;
+    uint32_t programPages = 0;
+    uint64_t programBytes = 0;
+    LatencyHistogram initialize;  // FlashParam::initialize()
+    LatencyHistogram commit;      // program() / service() which started to program the image
+    LatencyHistogram irqOff;      // safeExecute(), where interrupts are disabled on device
+    LatencyHistogram erase;       // per erase() of backend
+    LatencyHistogram program;     // per program() of backend
+    void print() const {
+        printf("Commits: %d, failures %d\r\n", static_cast<int>(commits), static_cast<int>(failures));
+        printf("Erase: %d sectors, %lld bytes\r\n", static_cast<int>(eraseSectors), static_cast<long long>(eraseBytes));
+        printf("Program: %d pages, %lld bytes\r\n", static_cast<int>(programPages), static_cast<long long>(programBytes));
+        initialize.print("Latency[initialize]");
+        commit.print("Latency[commit]");
+        irqOff.print("Latency[irqOff]");
+        erase.print("Latency[erase]");
+        program.print("Latency[program]");
+    }
+};
+}
@@ -0,0 +1,140 @@
+/*-----------------------------------------------------------/
+/ NameIndex.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <string_view>
+
+namespace FlashParamNs {
+//=================================
+// Interface of NameIndex class
+//=================================
+struct NameEntry {
+    std::string_view name;
+    uint32_t id;
+};
+
+// name to id index as a perfect hash built at compile time (hash and displace)
+//   names are grouped into buckets by a hash, and each bucket has the seed of the second hash
+//   which maps its names to the empty slots without collision, then find() is two hashes and a comparison
+//   duplicated names fail to compile, as does the index which has no seed found
+template <size_t N>
+class NameIndex
+{
+public:
+    constexpr NameIndex(const NameEntry (&entries)[N]) {
+        for (size_t i = 0; i < N; i++) { this->entries[i] = entries[i]; }
+        _build();
+    }
+    bool find(const std::string_view& name, uint32_t& id) const {
+        const uint32_t bucket = _hash(name, 0) % NumBuckets;
+        const uint16_t index = slots[_hash(name, seeds[bucket]) & (NumSlots - 1)];
+        if (index == EmptySlot || entries[index].name != name) { return false; }
+        id = entries[index].id;
+        return true;
+    }
+    static constexpr size_t size() { return N; }
+    // true if each id of [first, last] is in the index just once (to static_assert the index against the ids of the parameters)
+    constexpr bool coversIds(const uint32_t& first, const uint32_t& last) const {
+        if (last < first || N != last - first + 1) { return false; }
+        for (uint32_t id = first; id <= last; id++) {
+            size_t count = 0;
+            for (const auto& entry : entries) {
+                if (entry.id == id) { count++; }
+            }
+            if (count != 1) { return false; }
+        }
+        return true;
+    }
+    constexpr const NameEntry& operator[](const size_t& i) const { return entries[i]; }
+    // type-erased find() for FlashParam::setNameIndex()
+    static bool findIn(const void* index, const std::string_view& name, uint32_t& id) {
+        return static_cast<const NameIndex*>(index)->find(name, id);
+    }
+
+private:
+    static_assert(N > 0, "no name in the index");
+    static_assert(N < 0xffff, "too many names in the index");
+    static constexpr size_t _ceilPow2(const size_t& n) {
+        size_t p = 1;
+        while (p < n) { p <<= 1; }
+        return p;
+    }
+    static constexpr size_t NumSlots = _ceilPow2(N * 2);  // load factor up to 0.5
+    static constexpr size_t NumBuckets = (N + 3) / 4;
+    static constexpr uint16_t EmptySlot = 0xffff;
+    static constexpr uint32_t MaxSeed = 0xffff;
+    // FNV-1a with seed and final mix
+    static constexpr uint32_t _hash(const std::string_view& name, const uint32_t& seed) {
+        uint32_t h = 2166136261UL ^ (seed * 0x9e3779b9UL);
+        for (const char c : name) {
+            h ^= static_cast<uint8_t>(c);
+            h *= 16777619UL;
+        }
+        h ^= h >> 15;
+        h *= 0x2c1b3c6dUL;
+        h ^= h >> 12;
+        return h;
+    }
+    // not constexpr, then the call in the constant evaluation is a compile error
+    static void _duplicatedName() {}
+    static void _seedNotFound() {}
+    constexpr void _build() {
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i + 1; j < N; j++) {
+                if (entries[i].name == entries[j].name) { _duplicatedName(); }
+            }
+        }
+        std::array<uint32_t, N> bucketOf = {};
+        std::array<size_t, NumBuckets> bucketSize = {};
+        for (size_t i = 0; i < N; i++) {
+            bucketOf[i] = _hash(entries[i].name, 0) % NumBuckets;
+            bucketSize[bucketOf[i]]++;
+        }
+        for (auto& slot : slots) { slot = EmptySlot; }
+        // larger buckets first while more slots are empty
+        std::array<bool, NumBuckets> done = {};
+        for (size_t n = 0; n < NumBuckets; n++) {
+            size_t bucket = 0;
+            for (size_t b = 0; b < NumBuckets; b++) {
+                if (!done[b] && (done[bucket] || bucketSize[b] > bucketSize[bucket])) { bucket = b; }
+            }
+            done[bucket] = true;
+            if (bucketSize[bucket] == 0) { continue; }
+            uint32_t seed = 1;
+            while (!_place(bucketOf, bucket, seed)) {
+                if (++seed > MaxSeed) {
+                    _seedNotFound();
+                    break;
+                }
+            }
+            seeds[bucket] = static_cast<uint16_t>(seed);
+        }
+    }
+    // place the names of the bucket with the seed if all of them go to distinct empty slots
+    constexpr bool _place(const std::array<uint32_t, N>& bucketOf, const size_t& bucket, const uint32_t& seed) {
+        for (size_t i = 0; i < N; i++) {
+            if (bucketOf[i] != bucket) { continue; }
+            const size_t slot = _hash(entries[i].name, seed) & (NumSlots - 1);
+            if (slots[slot] != EmptySlot) {
+                for (size_t j = 0; j < i; j++) {  // undo
+                    if (bucketOf[j] == bucket) { slots[_hash(entries[j].name, seed) & (NumSlots - 1)] = EmptySlot; }
+                }
+                return false;
+            }
+            slots[slot] = static_cast<uint16_t>(i);
+        }
+        return true;
+    }
+    std::array<NameEntry, N> entries = {};
+    std::array<uint16_t, NumBuckets> seeds = {};
+    std::array<uint16_t, NumSlots> slots = {};
+};
+}
@@ -0,0 +1,136 @@
+/*-----------------------------------------------------------/
+/ ParamLayout.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <array>
+#include <tuple>
+#include <type_traits>
+
+#include "FlashParam.h"
+
+namespace FlashParamNs {
+//=================================
+// Interface of compile-time layout
+//=================================
+static constexpr uint32_t AutoFlashAddr = 0xffffffffUL;  // next to the previous item
+
+// parameter of type T with id located at flash address next to the previous item
+template <typename T, uint32_t Id, size_t Size = FlashSize<T>::value>
+struct Item {
+    using valueType = T;
+    static constexpr uint32_t id = Id;
+    static constexpr uint32_t flashAddr = AutoFlashAddr;
+    static constexpr size_t size = Size;
+};
+
+// parameter of type T with id located at designated flash address
+template <typename T, uint32_t Id, uint32_t FlashAddr, size_t Size = FlashSize<T>::value>
+struct ItemAt {
+    using valueType = T;
+    static constexpr uint32_t id = Id;
+    static constexpr uint32_t flashAddr = FlashAddr;
+    static constexpr size_t size = Size;
+};
+
+// Layout<Items...> resolves flash address of all parameters including built-in parameters,
+// and checks overlap and overflow of flash address, then computes CFG_MAP_HASH at compile time
+//   (the same addressing and hash as the parameters constructed without Layout<>)
+//   initialize() aborts if CFG_MAP_HASH of the parameters constructed by item<Id>() differs from MapHash,
+//   e.g. a parameter of the partition is missing in Layout<> or constructed without item<Id>()
+// LayoutOf<ImageSize, Items...> is for the partition whose image size is other than the default
+template <size_t ImageSize, typename... Items>
+class LayoutOf
+{
+    using AllItems = std::tuple<Item<uint32_t, CFG_MAP_HASH>, Item<uint32_t, CFG_STORE_COUNT>, Items...>;
+    static constexpr size_t N = std::tuple_size_v<AllItems>;
+    static constexpr std::array<uint32_t, N> ids = {CFG_MAP_HASH, CFG_STORE_COUNT, Items::id...};
+    static constexpr std::array<size_t, N> sizes = {sizeof(uint32_t), sizeof(uint32_t), Items::size...};
+    static constexpr std::array<size_t, N> typeIndices = {
+        HashTypeIndex<uint32_t>::value,
+        HashTypeIndex<uint32_t>::value,
+        HashTypeIndex<typename Items::valueType>::value...
+    };
+    static constexpr std::array<uint32_t, N> _resolveFlashAddrs() {
+        constexpr std::array<uint32_t, N> requested = {AutoFlashAddr, AutoFlashAddr, Items::flashAddr...};
+        std::array<uint32_t, N> addrs = {};
+        uint32_t nextFlashAddr = 0;
+        for (size_t i = 0; i < N; i++) {
+            addrs[i] = (requested[i] == AutoFlashAddr) ? nextFlashAddr : requested[i];
+            nextFlashAddr = addrs[i] + sizes[i];
+        }
+        return addrs;
+    }
+    static constexpr std::array<uint32_t, N> flashAddrs = _resolveFlashAddrs();
+    static constexpr bool _hasOverlap() {
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i + 1; j < N; j++) {
+                if (flashAddrs[i] < flashAddrs[j] + sizes[j] && flashAddrs[j] < flashAddrs[i] + sizes[i]) { return true; }
+            }
+        }
+        return false;
+    }
+    static constexpr bool _hasDuplicatedId() {
+        for (size_t i = 0; i < N; i++) {
+            for (size_t j = i + 1; j < N; j++) {
+                if (ids[i] == ids[j]) { return true; }
+            }
+        }
+        return false;
+    }
+    static constexpr size_t _getSize() {
+        size_t size = 0;
+        for (size_t i = 0; i < N; i++) {
+            if (flashAddrs[i] + sizes[i] > size) { size = flashAddrs[i] + sizes[i]; }
+        }
+        return size;
+    }
+    static constexpr uint32_t _getMapHash() {
+        uint32_t hash = Params::MapHashSeed;
+        for (size_t i = 0; i < N; i++) {
+            hash += flashAddrs[i]*Params::PRIME0 + static_cast<uint32_t>(sizes[i])*Params::PRIME1 + static_cast<uint32_t>(typeIndices[i])*Params::PRIME2;
+        }
+        return hash;
+    }
+    static constexpr size_t _indexOf(const uint32_t& id) {
+        for (size_t i = 0; i < N; i++) {
+            if (ids[i] == id) { return i; }
+        }
+        return N;
+    }
+    // Counter<N> and aggregate types occupy the size of the type, which can't be designated
+    static constexpr std::array<bool, N> resized = {false, false, (HasFixedFlashSize<typename Items::valueType>::value && Items::size != FlashSize<typename Items::valueType>::value)...};
+    static constexpr bool _hasResizedType() {
+        for (size_t i = 0; i < N; i++) {
+            if (resized[i]) { return true; }
+        }
+        return false;
+    }
+    static_assert(!_hasResizedType(), "size of Counter<N> and aggregate types must be the size of the type");
+    static_assert(!_hasDuplicatedId(), "duplicated parameter id");
+    static_assert(!_hasOverlap(), "flash address of parameters overlaps");
+    // FLASH_PARAM_SPARSE: flash address is used only for CFG_MAP_HASH, then parameters can exceed the image size
+    static_assert(FLASH_PARAM_SPARSE || _getSize() <= ImageSize, "parameters exceed the image size (UserReqSize)");
+
+public:
+    static constexpr size_t Size = _getSize();
+    static constexpr uint32_t MapHash = _getMapHash();
+    // the schema is stored with the image (FLASH_PARAM_MIGRATION), otherwise the image is stored without it
+    static constexpr bool HasRoomForSchema = Params::StoreSchema && ImageSize <= Params::MaxSchemaValue + 1 && _getSize() + Params::schemaSizeOf(N) <= ImageSize;
+    template <uint32_t Id>
+    static constexpr auto item() {
+        constexpr size_t i = _indexOf(Id);
+        static_assert(i < N, "id is not in the layout");
+        using T = typename std::tuple_element_t<i, AllItems>::valueType;
+        return LayoutItem<T>{Id, flashAddrs[i], sizes[i], MapHash};
+    }
+};
+
+template <typename... Items>
+using Layout = LayoutOf<UserFlash::DefaultRegion.size, Items...>;
+}
@@ -0,0 +1,72 @@
+/*-----------------------------------------------------------/
+/ PicoFlashBackend.cpp
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#include "PicoFlashBackend.h"
+
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include "pico/time.h"
+
+namespace FlashParamNs {
+FlashBackend& FlashBackend::instance()
+{
+    return PicoFlashBackend::instance();
+}
+
+//=================================
+// Implementation of PicoFlashBackend class
+//=================================
+PicoFlashBackend& PicoFlashBackend::instance()
+{
+    static PicoFlashBackend instance; // Singleton
+    return instance;
+}
+
+PicoFlashBackend::PicoFlashBackend()
+{
+    critical_section_init(&critSec);
+}
+
+const uint8_t* PicoFlashBackend::getReadAddr(const uint32_t& flash_ofs) const
+{
+    return reinterpret_cast<const uint8_t*>(XIP_BASE + flash_ofs);
+}
+
+void PicoFlashBackend::erase(const uint32_t& flash_ofs, const size_t& size)
+{
+    flash_range_erase(flash_ofs, size);
+}
+
+void PicoFlashBackend::program(const uint32_t& flash_ofs, const uint8_t* data, const size_t& size)
+{
+    flash_range_program(flash_ofs, data, size);
+}
+
+bool PicoFlashBackend::safeExecute(void (*func)(void*), void* param, const uint32_t& timeout_ms)
+{
+    // Need to stop interrupt during erase and program
+    // noted that if core1 is running, it must be stopped also if accessing flash
+    return flash_safe_execute(func, param, timeout_ms) == PICO_OK;
+}
+
+void PicoFlashBackend::lock()
+{
+    // safe between cores and also against interrupts
+    critical_section_enter_blocking(&critSec);
+}
+
+void PicoFlashBackend::unlock()
+{
+    critical_section_exit(&critSec);
+}
+
+uint64_t PicoFlashBackend::getTimeUs() const
+{
+    return time_us_64();
+}
+}
@@ -0,0 +1,36 @@
+/*-----------------------------------------------------------/
+/ PicoFlashBackend.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include "FlashBackend.h"
+#include "pico/critical_section.h"
+
+namespace FlashParamNs {
+//=================================
+// Interface of PicoFlashBackend class
+//=================================
+class PicoFlashBackend : public FlashBackend
+{
+public:
+    static PicoFlashBackend& instance(); // Singleton
+    const uint8_t* getReadAddr(const uint32_t& flash_ofs) const override;
+    void erase(const uint32_t& flash_ofs, const size_t& size) override;
+    void program(const uint32_t& flash_ofs, const uint8_t* data, const size_t& size) override;
+    bool safeExecute(void (*func)(void*), void* param, const uint32_t& timeout_ms) override;
+    void lock() override;
+    void unlock() override;
+    uint64_t getTimeUs() const override;
+
+protected:
+    PicoFlashBackend();
+    PicoFlashBackend(const PicoFlashBackend&) = delete;
+    PicoFlashBackend& operator=(const PicoFlashBackend&) = delete;
+    critical_section_t critSec;
+};
+}
@@ -0,0 +1,50 @@
+/*-----------------------------------------------------------/
+/ SeqLock.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace FlashParamNs {
+//=================================
+// Interface of SeqLock class
+//=================================
+// sequence lock for a single writer and any number of readers on the other cores
+//   the writer never waits, and readers never block the writer but retry while a write is in progress
+//   only plain atomic load / store is used (lock-free also on Cortex-M0+)
+class SeqLock
+{
+public:
+    void beginWrite() {
+        const uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_relaxed);  // odd while writing
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+    void endWrite() {
+        const uint32_t s = seq.load(std::memory_order_relaxed);
+        seq.store(s + 1, std::memory_order_release);
+    }
+    // func copies the protected data, which is retried until it's done without a concurrent write
+    template <typename F>
+    void read(F&& func) const {
+        uint32_t s0;
+        uint32_t s1;
+        do {
+            s0 = seq.load(std::memory_order_acquire);
+            if (s0 & 1) { continue; }
+            func();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            s1 = seq.load(std::memory_order_relaxed);
+            if (s0 == s1) { return; }
+        } while (true);
+    }
+private:
+    std::atomic<uint32_t> seq{0};
+};
+}
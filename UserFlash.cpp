@@ -6,9 +6,13 @@
 
 #include "UserFlash.h"
 
+#include <algorithm>
 #include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "Crc32.h"
 
-#include "pico/flash.h"
 
 namespace FlashParamNs {
 void _user_flash_program_core(void* ptr)
@@ -22,57 +26,270 @@ void _user_flash_program_core(void* ptr)
 //=================================
 UserFlash& UserFlash::instance()
 {
-    static UserFlash instance; // Singleton
+    static UserFlash instance(DefaultRegion); // Singleton
     return instance;
 }
 
-UserFlash::UserFlash()
+UserFlash::UserFlash(const UserFlashRegion& region) :
+    backend(FlashBackend::instance()),
+    name(region.name),
+    userReqSize(region.size),
+    pageProgSize(_pageProgSizeOf(region)),
+    ringMode(region.ringSectors > 0),
+    eraseSize(_eraseSizeOf(region)),
+    recordSize(pageProgSize + FLASH_PAGE_SIZE),
+    blockSectors(_blockSectorsOf(region)),
+    blockSize(blockSectors * FLASH_SECTOR_SIZE),
+    slotsPerBlock(blockSize / recordSize),
+    numSectors(_regionSizeOf(region) / FLASH_SECTOR_SIZE),
+    numSlots(slotsPerBlock * (numSectors / blockSectors)),
+    regionSize(_regionSizeOf(region)),
+    userFlashOfs(_regionOfsOf(region)),
+    wearOfs(pageProgSize + (CrcCheck ? FLASH_PAGE_SIZE : 0)),
+    wearEntrySize((numSectors + 1) * sizeof(uint32_t)),
+    numWearEntries((!ringMode && wearOfs + FLASH_PAGE_SIZE <= eraseSize) ? FLASH_PAGE_SIZE / wearEntrySize : 0),
+    tickOfs(wearOfs + FLASH_PAGE_SIZE),
+    numStoreTicks((numWearEntries > 0 && tickOfs + FLASH_PAGE_SIZE <= eraseSize) ? FLASH_PAGE_SIZE * 8 : 0),
+    eraseCounts(numSectors, 0)
 {
-    std::copy(flashContents, flashContents + data.size(), data.begin());
+    if (!isAvailableRegion(region)) { std::abort(); }
+    _instances().push_back(this);
+    reload();
 }
 
 UserFlash::~UserFlash()
 {
+    auto& instances = _instances();
+    instances.erase(std::remove(instances.begin(), instances.end(), this), instances.end());
+}
+
+bool UserFlash::isAvailableRegion(const UserFlashRegion& region)
+{
+    if (!isValidRegion(region)) { return false; }
+    const uint32_t ofs = _regionOfsOf(region);
+    const size_t size = _regionSizeOf(region);
+    for (const auto* inst : _instances()) {
+        if (ofs < inst->userFlashOfs + inst->regionSize && inst->userFlashOfs < ofs + size) { return false; }
+    }
+    return true;
+}
+
+std::vector<const UserFlash*>& UserFlash::_instances()
+{
+    static std::vector<const UserFlash*> instances;  // constructed on the first use, not to depend on the order of static initialization
+    return instances;
 }
 
 void UserFlash::printInfo()
 {
-    printf("=== UserFlash ===\r\n");
+    printf("=== UserFlash (%s) ===\r\n", name);
     _printValue("FlashSize", PICO_FLASH_SIZE_BYTES, true);
     _printValue("SectorSize", FLASH_SECTOR_SIZE, true);
     _printValue("PageSize", FLASH_PAGE_SIZE, true);
-    _printValue("UserReqSize", UserReqSize, true);
-    _printValue("EraseSize", EraseSize, true);
-    _printValue("PageProgSize", PageProgSize, true);
-    _printValue("UserFlashOfs", UserFlashOfs);
-    _printValue("UserFlashReadAddr", reinterpret_cast<const int>(flashContents));
+    _printValue("UserReqSize", userReqSize, true);
+    _printValue("EraseSize", eraseSize, true);
+    _printValue("PageProgSize", pageProgSize, true);
+    _printValue("RegionSize", regionSize, true);
+    _printValue("UserFlashOfs", userFlashOfs);
+    _printValue("UserFlashReadAddr", static_cast<int>(reinterpret_cast<uintptr_t>(flashContents)));
+    if (ringMode) {
+        _printValue("RingSectors", numSectors, true);
+        _printValue("RecordSize", recordSize, true);
+        _printValue("SectorsPerBlock", blockSectors, true);
+        _printValue("SlotsPerBlock", slotsPerBlock, true);
+        _printValue("CurrentSlot", currentSlot, true);
+        _printValue("CurrentSeq", currentSeq, true);
+    }
+    if (CrcCheck) {
+        if (flashContents != nullptr) {
+            _printValue("ImageCrc", static_cast<int>(Crc32::calc(flashContents, pageProgSize)));
+        }
+        _printValue("CrcErrorCount", crcErrorCount, true);
+    }
+    for (size_t i = 0; i < eraseCounts.size(); i++) {
+        printf("EraseCount[%d]: %d\r\n", static_cast<int>(i), static_cast<int>(eraseCounts.at(i)));
+    }
+    printf("EraseCountPersistent: %s\r\n", isEraseCountPersistent() ? "true" : "false");
+    if (numStoreTicks > 0) {
+        printf("StoreTicks: %d / %d\r\n", static_cast<int>(getStoreTicks()), static_cast<int>(numStoreTicks));
+    }
+    stats.print();
 }
 
-bool UserFlash::program()
+bool UserFlash::isModified() const
 {
-    // Need to stop interrupt during erase and program
-    // noted that if core1 is running, it must be stopped also if accessing flash
-    int result = flash_safe_execute(_user_flash_program_core, this, 100);
-    if (result != PICO_OK) {
+    if (data.empty()) {
         return false;
     }
+    return _isImageModified(data.data());
+}
+
+bool UserFlash::canProgramInPlace() const
+{
+    // fixed mode only: ring mode appends a record to keep the previous one intact on power loss
+    if (ringMode || data.empty()) { return false; }
+    if (CrcCheck && _findNextCrcEntry() >= NumCrcEntries) { return false; }
+    return _isClearOnly(data.data(), _getReadAddr(0), pageProgSize);
+}
+
+size_t UserFlash::getStoreTicks() const
+{
+    // cleared bits of the page, which are counted only with the valid image
+    if (numStoreTicks == 0) { return 0; }
+    backend.lock();
+    size_t ticks = 0;
+    if (flashContents != nullptr) {
+        const auto page = _getReadAddr(tickOfs);
+        for (size_t i = 0; i < FLASH_PAGE_SIZE; i++) {
+            for (uint8_t bits = ~page[i]; bits != 0; bits &= bits - 1) { ticks++; }
+        }
+    }
+    backend.unlock();
+    return ticks;
+}
+
+bool UserFlash::canTickInPlace() const
+{
+    // the count in the blank image can't be kept as the base of ticks
+    if (numStoreTicks == 0 || flashContents == nullptr || _isErased(flashContents, pageProgSize)) { return false; }
+    return getStoreTicks() < numStoreTicks && canProgramInPlace();
+}
+
+bool UserFlash::program(bool tick)
+{
+    waitIdle();
+    const uint64_t startUs = backend.getTimeUs();
+    // skip if the image is the same as flash contents
+    if (!isModified()) {
+        return true;
+    }
+    programImage = data.data();
+    programTick = tick;
+    const bool result = _safeProgram(startUs);
+    // reflect the result of program to the staged image
+    if (flashContents != nullptr) {
+        std::copy(flashContents, flashContents + data.size(), data.begin());
+    }
+    return result;
+}
+
+void UserFlash::programAsync(commit_callback_t callback, void* context, bool tick)
+{
+    if (data.empty()) { _loadImage(); }
+    // buffers are allocated only at the first request, when service() doesn't touch them yet
+    if (requestImage.empty()) {
+        requestImage.resize(pageProgSize);
+        commitImage.resize(pageProgSize);
+    }
+    commit_callback_t supersededCallback = nullptr;
+    void* supersededContext = nullptr;
+    backend.lock();
+    if (requested) {
+        supersededCallback = requestCallback;
+        supersededContext = requestContext;
+    }
+    std::copy(data.begin(), data.end(), requestImage.begin());
+    requestCallback = callback;
+    requestContext = context;
+    requestTick = tick;
+    requested = true;
+    backend.unlock();
+    if (supersededCallback != nullptr) { supersededCallback(COMMIT_SUPERSEDED, supersededContext); }
+}
+
+bool UserFlash::service()
+{
+    backend.lock();
+    if (!requested) {
+        backend.unlock();
+        return false;
+    }
+    const uint64_t startUs = backend.getTimeUs();
+    requestImage.swap(commitImage);
+    const auto callback = requestCallback;
+    const auto context = requestContext;
+    const bool tick = requestTick;
+    requested = false;
+    inProgress = true;
+    backend.unlock();
+
+    bool success = true;
+    if (_isImageModified(commitImage.data())) {
+        programImage = commitImage.data();
+        programTick = tick;
+        success = _safeProgram(startUs);
+    }
+    const CommitResult_t result = success ? COMMIT_SUCCESS : COMMIT_FAILURE;
+
+    backend.lock();
+    inProgress = false;
+    lastResult = result;
+    backend.unlock();
+    if (callback != nullptr) { callback(result, context); }
     return true;
 }
 
+bool UserFlash::isBusy() const
+{
+    backend.lock();
+    const bool busy = requested || inProgress;
+    backend.unlock();
+    return busy;
+}
+
+CommitResult_t UserFlash::getLastResult() const
+{
+    backend.lock();
+    const auto result = lastResult;
+    backend.unlock();
+    return result;
+}
+
 bool UserFlash::clear()
 {
+    if (data.empty()) { _loadImage(); }
     for (auto& item : data) { item = 0xff; }
     return program();
 }
 
+void UserFlash::waitIdle()
+{
+    // the request not started yet is superseded, and wait for the commit in progress
+    backend.lock();
+    const auto callback = requested ? requestCallback : nullptr;
+    const auto context = requestContext;
+    requested = false;
+    backend.unlock();
+    if (callback != nullptr) { callback(COMMIT_SUPERSEDED, context); }
+    while (isBusy()) {}
+}
+
+void UserFlash::reload()
+{
+    // (re)build the state from flash contents, e.g. after reset or flash modified from outside
+    crcErrorCount = 0;
+    if (ringMode) {
+        _scanRing();
+    } else {
+        flashContents = _getReadAddr(0);
+        if (CrcCheck) { _checkFixedCrc(); }
+        if (numWearEntries > 0) { _loadWearEntry(); }
+    }
+    // the staged image follows flash contents, which is allocated on the first finalize() and kept afterwards if XipRead
+    if (!XipRead || !data.empty()) {
+        _loadImage();
+    }
+}
+
 void UserFlash::dump()
 {
-    for (int i = 0; i < data.size(); i += 16) {
-        for (int j = 0; j < 16; j++) {
+    if (data.empty()) { _loadImage(); }
+    for (size_t i = 0; i < data.size(); i += 16) {
+        for (size_t j = 0; j < 16; j++) {
             if (i + j >= data.size()) { break; }
             printf("%02x ", static_cast<int>(data.at(i+j)));
         }
-        for (int j = 0; j < 16; j++) {
+        for (size_t j = 0; j < 16; j++) {
             if (i + j >= data.size()) { break; }
             if (data.at(i+j) >= 0x20 && data.at(i+j) <= 0x7E) {
                 printf("%c", data.at(i+j));
@@ -84,11 +301,335 @@ void UserFlash::dump()
     }
 }
 
+void UserFlash::_loadImage()
+{
+    data.resize(pageProgSize);
+    if (flashContents == nullptr) {
+        std::fill(data.begin(), data.end(), 0xff);
+    } else {
+        std::copy(flashContents, flashContents + data.size(), data.begin());
+    }
+}
+
+bool UserFlash::_isImageModified(const uint8_t* image) const
+{
+    if (flashContents == nullptr) {
+        return !_isErased(image, pageProgSize);
+    }
+    return !std::equal(image, image + pageProgSize, flashContents);
+}
+
 void UserFlash::_programCore()
 {
-    flash_range_erase(UserFlashOfs, EraseSize);
-    flash_range_program(UserFlashOfs, data.data(), data.size());
-    std::copy(flashContents, flashContents + data.size(), data.begin());
+    if (ringMode) {
+        _programRingCore();
+    } else {
+        const size_t crcSector = pageProgSize / FLASH_SECTOR_SIZE;
+        const size_t crcEntry = CrcCheck ? _findNextCrcEntry() : 0;
+        const size_t wearSector = wearOfs / FLASH_SECTOR_SIZE;
+        const size_t wearEntry = (numWearEntries > 0) ? _findNextWearEntry() : 0;
+        // store ticks are erased by the store which counts up CFG_STORE_COUNT in the image instead
+        const size_t tickSector = tickOfs / FLASH_SECTOR_SIZE;
+        const bool tickReset = numStoreTicks > 0 && !programTick && !_isBlank(tickOfs, FLASH_PAGE_SIZE);
+        // the sector of erase count entries is also erased if no entry is left for this erase
+        bool eraseAny = tickReset;
+        for (size_t sector = 0; sector < numSectors && !eraseAny; sector++) { eraseAny = _isEraseNeeded(sector, crcEntry); }
+        const bool wearFull = numWearEntries > 0 && eraseAny && wearEntry >= numWearEntries;
+        bool crcSectorErased = false;
+        bool wearSectorErased = false;
+        for (size_t sector = 0; sector < numSectors; sector++) {
+            if (_isEraseNeeded(sector, crcEntry) || (wearFull && sector == wearSector) || (tickReset && sector == tickSector)) {
+                _erase(userFlashOfs + sector * FLASH_SECTOR_SIZE, FLASH_SECTOR_SIZE);
+                eraseCounts.at(sector)++;
+                if (sector == crcSector) { crcSectorErased = true; }
+                if (sector == wearSector) { wearSectorErased = true; }
+            }
+        }
+        // pages of erased sectors are regarded as modified against blank flash
+        _programPages(userFlashOfs, true);
+        if (CrcCheck) { _appendCrcEntry(crcSectorErased ? 0 : crcEntry); }
+        if (numWearEntries > 0 && eraseAny) { _appendWearEntry(wearSectorErased ? 0 : wearEntry); }
+        // the tick at last, then the count on power loss before it misses only this store
+        if (programTick && numStoreTicks > 0) { _appendStoreTick(); }
+        flashContents = _getReadAddr(0);
+    }
+}
+
+void UserFlash::_programRingCore()
+{
+    const int slot = _findNextSlot();
+    const size_t block = slot / slotsPerBlock;
+    const size_t sector = block * blockSectors;
+    const uint32_t ofs = _slotOfs(slot);
+    if (!_isBlank(ofs, recordSize)) {
+        _erase(userFlashOfs + block * blockSize, blockSize);
+        for (size_t i = 0; i < blockSectors; i++) { eraseCounts.at(sector + i)++; }
+    }
+    // program the image first, then the trailer, and the commit marker at last to mark the record as valid
+    // the newest record is kept intact until then, so that power loss at any point leaves a valid record
+    const uint32_t crc = CrcCheck ? Crc32::calc(programImage, pageProgSize) : 0xffffffffUL;
+    RecordTrailer trailer = {RecordMagic, currentSeq + 1, eraseCounts.at(sector), crc, 0xffffffffUL};
+    std::array<uint8_t, FLASH_PAGE_SIZE> trailerPage;
+    trailerPage.fill(0xff);
+    std::memcpy(trailerPage.data(), &trailer, sizeof(trailer));
+    _programPages(userFlashOfs + ofs, false);
+    _program(userFlashOfs + ofs + pageProgSize, trailerPage.data(), trailerPage.size());
+    // the same trailer with the commit marker, then the page is reprogrammed only by clearing bits
+    trailer.commit = CommitMarker;
+    std::memcpy(trailerPage.data(), &trailer, sizeof(trailer));
+    _program(userFlashOfs + ofs + pageProgSize, trailerPage.data(), trailerPage.size());
+    currentSlot = slot;
+    currentSeq = trailer.seq;
+    flashContents = _getReadAddr(ofs);
+}
+
+void UserFlash::_scanRing()
+{
+    currentSlot = NoSlot;
+    std::fill(eraseCounts.begin(), eraseCounts.end(), 0);
+    uint32_t maxSeq = 0;
+    for (int slot = 0; slot < static_cast<int>(numSlots); slot++) {
+        if (!_isValidSlot(slot)) { continue; }
+        const auto trailer = _getTrailer(slot);
+        const size_t sector = (slot / slotsPerBlock) * blockSectors;
+        std::fill_n(eraseCounts.begin() + sector, blockSectors, trailer->eraseCount);
+        maxSeq = std::max(maxSeq, trailer->seq);
+    }
+    // the newest record, or the newest one among the records without CRC error
+    uint32_t seqLimit = 0xffffffffUL;
+    while (currentSlot == NoSlot) {
+        int newest = NoSlot;
+        for (int slot = 0; slot < static_cast<int>(numSlots); slot++) {
+            if (!_isValidSlot(slot)) { continue; }
+            const auto trailer = _getTrailer(slot);
+            if (trailer->seq < seqLimit && (newest == NoSlot || trailer->seq > _getTrailer(newest)->seq)) {
+                newest = slot;
+            }
+        }
+        if (newest == NoSlot) { break; }
+        const auto trailer = _getTrailer(newest);
+        if (CrcCheck && !_isCrcValid(_getReadAddr(_slotOfs(newest)), trailer->crc)) {
+            crcErrorCount++;
+            seqLimit = trailer->seq;
+            continue;
+        }
+        currentSlot = newest;
+    }
+    // the next record must be newer than any record on flash including the ones with CRC error
+    currentSeq = maxSeq;
+    if (currentSlot == NoSlot) {
+        flashContents = nullptr;
+    } else {
+        flashContents = _getReadAddr(_slotOfs(currentSlot));
+    }
+}
+
+int UserFlash::_findNextSlot() const
+{
+    // the slot next to the newest record if it's blank,
+    // otherwise the first slot of the following block which doesn't hold the newest record (to be erased)
+    const int currentBlock = (currentSlot == NoSlot) ? -1 : currentSlot / static_cast<int>(slotsPerBlock);
+    int slot = (currentSlot == NoSlot) ? 0 : (currentSlot + 1) % static_cast<int>(numSlots);
+    for (size_t i = 0; i < numSlots; i++) {
+        if (_isBlank(_slotOfs(slot), recordSize)) { return slot; }
+        const int block = slot / static_cast<int>(slotsPerBlock);
+        if (slot % slotsPerBlock == 0 && block != currentBlock) { return slot; }
+        slot = ((block + 1) * slotsPerBlock) % numSlots;
+    }
+    // only the block holding the newest record is left (single block ring), which loses the newest record on power loss until the next commit
+    return currentBlock * slotsPerBlock;
+}
+
+uint32_t UserFlash::_slotOfs(const int& slot) const
+{
+    return (slot / slotsPerBlock) * blockSize + (slot % slotsPerBlock) * recordSize;
+}
+
+const UserFlash::RecordTrailer* UserFlash::_getTrailer(const int& slot) const
+{
+    return reinterpret_cast<const RecordTrailer*>(_getReadAddr(_slotOfs(slot) + pageProgSize));
+}
+
+bool UserFlash::_isValidSlot(const int& slot) const
+{
+    const auto trailer = _getTrailer(slot);
+    return trailer->magic == RecordMagic && trailer->seq != 0xffffffffUL && trailer->commit == CommitMarker;
+}
+
+bool UserFlash::_isCrcValid(const uint8_t* image, const uint32_t& crc) const
+{
+    return Crc32::calc(image, pageProgSize) == crc;
+}
+
+void UserFlash::_checkFixedCrc()
+{
+    // the last complete CRC entry is for the current image
+    const auto entries = reinterpret_cast<const CrcEntry*>(_getReadAddr(pageProgSize));
+    const CrcEntry* last = nullptr;
+    for (size_t i = 0; i < NumCrcEntries; i++) {
+        if (entries[i].inv == ~entries[i].crc) { last = &entries[i]; }
+    }
+    if (last == nullptr) {
+        // blank, or the image is programmed without CRC (incomplete or by FLASH_PARAM_CRC=0)
+        if (!_isBlank(0, pageProgSize)) { crcErrorCount++; }
+        flashContents = nullptr;
+    } else if (!_isCrcValid(flashContents, last->crc)) {
+        crcErrorCount++;
+        flashContents = nullptr;
+    }
+}
+
+size_t UserFlash::_findNextCrcEntry() const
+{
+    // next to the last non-blank entry (partially programmed entry is skipped)
+    const auto entries = reinterpret_cast<const CrcEntry*>(_getReadAddr(pageProgSize));
+    size_t next = 0;
+    for (size_t i = 0; i < NumCrcEntries; i++) {
+        if (!_isErased(reinterpret_cast<const uint8_t*>(&entries[i]), sizeof(CrcEntry))) { next = i + 1; }
+    }
+    return next;
+}
+
+void UserFlash::_appendCrcEntry(const size_t& index)
+{
+    const uint32_t crc = Crc32::calc(programImage, pageProgSize);
+    const CrcEntry entry = {crc, ~crc};
+    std::array<uint8_t, FLASH_PAGE_SIZE> page;
+    page.fill(0xff);
+    std::memcpy(page.data() + index * sizeof(CrcEntry), &entry, sizeof(entry));
+    _program(userFlashOfs + pageProgSize, page.data(), page.size());
+}
+
+bool UserFlash::_isEraseNeeded(const size_t& sector, const size_t& crcEntry) const
+{
+    // erase is needed only for the sectors where any of modified pages needs to set bits from 0 to 1
+    //   (the other modified pages are programmed in place, e.g. still blank or only clearing flags)
+    const uint32_t sectorEnd = std::min((sector + 1) * FLASH_SECTOR_SIZE, pageProgSize);
+    for (uint32_t ofs = sector * FLASH_SECTOR_SIZE; ofs < sectorEnd; ofs += FLASH_PAGE_SIZE) {
+        if (_isPageModified(ofs) && !_isClearOnly(programImage + ofs, _getReadAddr(ofs), FLASH_PAGE_SIZE)) { return true; }
+    }
+    // or for the sector of CRC entries if no entry is left
+    return CrcCheck && sector == pageProgSize / FLASH_SECTOR_SIZE && crcEntry >= NumCrcEntries;
+}
+
+void UserFlash::_loadWearEntry()
+{
+    // the last complete entry holds the latest erase counts (0 if no entry e.g. programmed by the older version)
+    std::fill(eraseCounts.begin(), eraseCounts.end(), 0);
+    for (size_t i = 0; i < numWearEntries; i++) {
+        const auto entry = _getReadAddr(wearOfs + i * wearEntrySize);
+        const size_t countsSize = numSectors * sizeof(uint32_t);
+        uint32_t check;
+        std::memcpy(&check, entry + countsSize, sizeof(check));
+        if (check == ~Crc32::calc(entry, countsSize)) {
+            std::memcpy(eraseCounts.data(), entry, countsSize);
+        }
+    }
+}
+
+size_t UserFlash::_findNextWearEntry() const
+{
+    // next to the last non-blank entry (partially programmed entry is skipped)
+    size_t next = 0;
+    for (size_t i = 0; i < numWearEntries; i++) {
+        if (!_isBlank(wearOfs + i * wearEntrySize, wearEntrySize)) { next = i + 1; }
+    }
+    return next;
+}
+
+void UserFlash::_appendWearEntry(const size_t& index)
+{
+    const size_t countsSize = numSectors * sizeof(uint32_t);
+    const uint32_t check = ~Crc32::calc(reinterpret_cast<const uint8_t*>(eraseCounts.data()), countsSize);
+    std::array<uint8_t, FLASH_PAGE_SIZE> page;
+    page.fill(0xff);
+    std::memcpy(page.data() + index * wearEntrySize, eraseCounts.data(), countsSize);
+    std::memcpy(page.data() + index * wearEntrySize + countsSize, &check, sizeof(check));
+    _program(userFlashOfs + wearOfs, page.data(), page.size());
+}
+
+void UserFlash::_appendStoreTick()
+{
+    // clear the lowest bit left in the page
+    std::array<uint8_t, FLASH_PAGE_SIZE> page;
+    std::copy(_getReadAddr(tickOfs), _getReadAddr(tickOfs) + FLASH_PAGE_SIZE, page.begin());
+    const auto it = std::find_if(page.begin(), page.end(), [](const uint8_t& v) { return v != 0; });
+    if (it == page.end()) { return; }
+    *it &= *it - 1;
+    _program(userFlashOfs + tickOfs, page.data(), page.size());
+}
+
+bool UserFlash::_safeProgram(const uint64_t& startUs)
+{
+    // Need to stop interrupt during erase and program (see PicoFlashBackend::safeExecute())
+    const uint64_t irqOffStartUs = backend.getTimeUs();
+    const bool result = backend.safeExecute(_user_flash_program_core, this, 100);
+    const uint64_t endUs = backend.getTimeUs();
+    // stats can be read by the other core while service() runs in background
+    backend.lock();
+    stats.commits++;
+    if (result) {
+        stats.irqOff.add(static_cast<uint32_t>(endUs - irqOffStartUs));
+    } else {
+        stats.failures++;
+    }
+    stats.commit.add(static_cast<uint32_t>(endUs - startUs));
+    backend.unlock();
+    return result;
+}
+
+void UserFlash::_erase(const uint32_t& flash_ofs, const size_t& size)
+{
+    const uint64_t startUs = backend.getTimeUs();
+    backend.erase(flash_ofs, size);
+    stats.erase.add(static_cast<uint32_t>(backend.getTimeUs() - startUs));
+    stats.eraseSectors += size / FLASH_SECTOR_SIZE;
+    stats.eraseBytes += size;
+}
+
+void UserFlash::_program(const uint32_t& flash_ofs, const uint8_t* data, const size_t& size)
+{
+    const uint64_t startUs = backend.getTimeUs();
+    backend.program(flash_ofs, data, size);
+    stats.program.add(static_cast<uint32_t>(backend.getTimeUs() - startUs));
+    stats.programPages += size / FLASH_PAGE_SIZE;
+    stats.programBytes += size;
+}
+
+bool UserFlash::_isBlank(const uint32_t& ofs, const size_t& size) const
+{
+    return _isErased(_getReadAddr(ofs), size);
+}
+
+bool UserFlash::_isPageModified(const uint32_t& page_ofs) const
+{
+    // compare with raw flash contents (fixed mode), which can be non-blank even if there is no valid image
+    const auto ptr = programImage + page_ofs;
+    return !std::equal(ptr, ptr + FLASH_PAGE_SIZE, _getReadAddr(page_ofs));
+}
+
+void UserFlash::_programPages(const uint32_t& flash_ofs, bool modifiedOnly)
+{
+    // the target pages are assumed to be blank or to need only clearing bits. pages of all 0xff don't need to be programmed
+    for (uint32_t ofs = 0; ofs < pageProgSize; ofs += FLASH_PAGE_SIZE) {
+        if (_isErased(programImage + ofs, FLASH_PAGE_SIZE)) { continue; }
+        if (modifiedOnly && !_isPageModified(ofs)) { continue; }
+        _program(flash_ofs + ofs, programImage + ofs, FLASH_PAGE_SIZE);
+    }
+}
+
+bool UserFlash::_isClearOnly(const uint8_t* image, const uint8_t* flash, const size_t& size)
+{
+    // NOR flash programs only 1 -> 0 of bits
+    for (size_t i = 0; i < size; i++) {
+        if (image[i] & ~flash[i]) { return false; }
+    }
+    return true;
+}
+
+bool UserFlash::_isErased(const uint8_t* ptr, const size_t& size)
+{
+    return std::all_of(ptr, ptr + size, [](const uint8_t& v) { return v == 0xff; });
 }
 
 void UserFlash::_printValue(const char* name, int value, bool decimal)
@@ -8,64 +8,318 @@
 
 #include <array>
 #include <string>
+#include <vector>
 
-#include "hardware/flash.h"
+#include "FlashBackend.h"
+#include "FlashStats.h"
+
+// FLASH_PARAM_SIZE
+//   size of the image in bytes (default: 1024), which can exceed a sector
+#ifndef FLASH_PARAM_SIZE
+#define FLASH_PARAM_SIZE 1024
+#endif
+
+// FLASH_PARAM_OFFSET
+//   0 (default): the region is located at the end of flash
+//   OFS        : the region is located at OFS from the beginning of flash (must be aligned to FLASH_SECTOR_SIZE)
+#ifndef FLASH_PARAM_OFFSET
+#define FLASH_PARAM_OFFSET 0
+#endif
+
+// FLASH_PARAM_RING_SECTORS
+//   0 (default): the image is stored at the beginning of the last sector, which is erased on every program()
+//   N (>= 1)   : the image is appended as a record into the ring of N sectors at the end of flash
+//                and a sector is erased only when the ring wraps around to it (log-structured mode)
+//                if a record exceeds a sector, N must be a multiple of the sectors per record
+//                the commit is power-fail-safe only if N is 2 blocks (of the sectors per record) or more,
+//                since a single block ring erases the newest record before appending the next one
+#ifndef FLASH_PARAM_RING_SECTORS
+#define FLASH_PARAM_RING_SECTORS 0
+#endif
+
+// FLASH_PARAM_XIP_READ
+//   0 (default): parameters are copied from flash at initialize() and the image is shadowed on RAM
+//   1          : unmodified parameters are read directly from XIP-mapped flash,
+//                and the image is staged on RAM only while finalize() is in progress
+#ifndef FLASH_PARAM_XIP_READ
+#define FLASH_PARAM_XIP_READ 0
+#endif
+
+// FLASH_PARAM_CRC
+//   0 (default): the image is not checked except CFG_MAP_HASH
+//   1          : CRC32 of the image is programmed with the image and verified on load,
+//                then the image with CRC error is treated as blank (or the previous record in ring mode)
+#ifndef FLASH_PARAM_CRC
+#define FLASH_PARAM_CRC 0
+#endif
 
 namespace FlashParamNs {
+typedef enum {
+    COMMIT_SUCCESS = 0,
+    COMMIT_FAILURE,
+    COMMIT_SUPERSEDED,  // replaced by the newer request before the commit started
+} CommitResult_t;
+
+// called from the context which commits (see UserFlash::service())
+using commit_callback_t = void (*)(CommitResult_t result, void* context);
+
+// region of flash which holds the image of a partition (see FlashParam)
+struct UserFlashRegion {
+    const char* name;
+    uint32_t ofs;        // offset from the beginning of flash (0: located at the end of flash)
+    size_t size;         // size of the image in bytes
+    size_t ringSectors;  // 0: fixed mode, N: log-structured ring of N sectors (see FLASH_PARAM_RING_SECTORS)
+};
+
 //=================================
 // Interface of UserFlash class
 //=================================
 class UserFlash
 {
 public:
-    static UserFlash& instance(); // Singleton
+    static UserFlash& instance(); // Singleton of the default region
+    static constexpr UserFlashRegion DefaultRegion = {"default", FLASH_PARAM_OFFSET, FLASH_PARAM_SIZE, FLASH_PARAM_RING_SECTORS};
+    explicit UserFlash(const UserFlashRegion& region);
+    virtual ~UserFlash();
+    static constexpr bool isValidRegion(const UserFlashRegion& region) {
+        return region.size > 0 &&
+               (region.ringSectors == 0 || region.ringSectors % _blockSectorsOf(region) == 0) &&
+               _regionOfsOf(region) % FLASH_SECTOR_SIZE == 0 &&
+               _regionSizeOf(region) <= PICO_FLASH_SIZE_BYTES &&
+               _regionOfsOf(region) <= PICO_FLASH_SIZE_BYTES - _regionSizeOf(region);
+    }
+    // the previous record stays intact until the next one is committed (ring of 2 blocks or more)
+    static constexpr bool isPowerFailSafe(const UserFlashRegion& region) {
+        return region.ringSectors >= _blockSectorsOf(region) * 2;
+    }
+    static constexpr bool isOverlapping(const UserFlashRegion& a, const UserFlashRegion& b) {
+        return _regionOfsOf(a) < _regionOfsOf(b) + _regionSizeOf(b) &&
+               _regionOfsOf(b) < _regionOfsOf(a) + _regionSizeOf(a);
+    }
+    // valid and not overlapping the regions of the instances which exist, otherwise the constructor aborts
+    static bool isAvailableRegion(const UserFlashRegion& region);
     void printInfo();
     template <typename T>
     void read(const uint32_t& flash_ofs, const size_t& size, T& value) {
-        if (flash_ofs + size <= PageProgSize) {
-            auto ptr = reinterpret_cast<uint8_t*>(&value);
-            std::copy(flashContents + flash_ofs, flashContents + flash_ofs + size, ptr);
-        }
+        readBytes(flash_ofs, size, reinterpret_cast<uint8_t*>(&value));
     }
+    // flashContents is switched by service() in background, which is guarded by lock()
     void read(const uint32_t& flash_ofs, const size_t& size, std::string& value) {
-        if (flash_ofs + size <= PageProgSize) {
-            value.clear();
-            std::copy(flashContents + flash_ofs, flashContents + flash_ofs + size, std::back_inserter(value));
+        if (flash_ofs + size <= pageProgSize) {
+            backend.lock();
+            if (flashContents == nullptr) {  // no valid record: behave as blank flash
+                value.assign(size, '\xff');
+            } else {
+                value.assign(reinterpret_cast<const char*>(flashContents + flash_ofs), size);
+            }
+            backend.unlock();
+        }
+    }
+    void readBytes(const uint32_t& flash_ofs, const size_t& size, uint8_t* ptr) {
+        if (flash_ofs + size <= pageProgSize) {
+            backend.lock();
+            if (flashContents == nullptr) {  // no valid record: behave as blank flash
+                std::fill(ptr, ptr + size, 0xff);
+            } else {
+                std::copy(flashContents + flash_ofs, flashContents + flash_ofs + size, ptr);
+            }
+            backend.unlock();
         }
     }
     template <typename T>
     void writeReserve(const uint32_t& flash_ofs, const size_t& size, const T& value) {
-        if (flash_ofs + size <= PageProgSize) {
-            auto ptr = reinterpret_cast<const uint8_t*>(&value);
-            std::copy(&ptr[0], &ptr[0] + size, data.data() + flash_ofs);
-        }
+        writeReserveBytes(flash_ofs, size, reinterpret_cast<const uint8_t*>(&value));
     }
     void writeReserve(const uint32_t& flash_ofs, const size_t& size, const std::string& value) {
-        if (flash_ofs + size <= PageProgSize) {
-            std::copy(&value[0], &value[0] + size, data.data() + flash_ofs);
+        writeReserveBytes(flash_ofs, size, reinterpret_cast<const uint8_t*>(&value[0]));
+    }
+    void writeReserveBytes(const uint32_t& flash_ofs, const size_t& size, const uint8_t* ptr) {
+        if (flash_ofs + size <= pageProgSize) {
+            if (data.empty()) { _loadImage(); }
+            std::copy(ptr, ptr + size, data.data() + flash_ofs);
+        }
+    }
+    void fillReserve(const uint32_t& flash_ofs, const size_t& size, const uint8_t& value) {
+        if (flash_ofs + size <= pageProgSize) {
+            if (data.empty()) { _loadImage(); }
+            std::fill(data.data() + flash_ofs, data.data() + flash_ofs + size, value);
         }
     }
-    bool program();
+    // address of the value on XIP-mapped flash if it can be read directly, otherwise nullptr
+    template <typename T>
+    const T* getMappedAddr(const uint32_t& flash_ofs, const size_t& size) const {
+        // bool is excluded since an arbitrary flash byte is not a valid bool representation
+        if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+            if (flashContents != nullptr && size == sizeof(T) && flash_ofs + size <= pageProgSize) {
+                const auto ptr = flashContents + flash_ofs;
+                if (reinterpret_cast<uintptr_t>(ptr) % alignof(T) == 0) {
+                    return reinterpret_cast<const T*>(ptr);
+                }
+            }
+        }
+        return nullptr;
+    }
+    void reload();
+    bool isModified() const;
+    // the staged image can be programmed without erase since it only clears bits on flash (fixed mode)
+    bool canProgramInPlace() const;
+    // store ticks: unary count in the spare page after erase count entries (fixed mode), each of which is a bit cleared
+    //   by the store programmed in place instead of counting up CFG_STORE_COUNT in the image, and erased by the other store
+    size_t getStoreTicks() const;
+    // the staged image can be programmed in place with a store tick, where the previous image isn't blank
+    bool canTickInPlace() const;
+    // tick: clear a bit of store ticks after the image, otherwise store ticks are erased if any
+    bool program(bool tick = false);
+    // asynchronous program: the image is copied at request, then programmed by service() from background context
+    void programAsync(commit_callback_t callback = nullptr, void* context = nullptr, bool tick = false);
+    bool service();
+    bool isBusy() const;
+    void waitIdle();
+    CommitResult_t getLastResult() const;
     bool clear();
     void dump();
+    const char* getName() const { return name; }
+    size_t getNumSectors() const { return numSectors; }
+    uint32_t getEraseCount(const size_t& sector) const {
+        backend.lock();
+        const uint32_t count = eraseCounts.at(sector);
+        backend.unlock();
+        return count;
+    }
+    // erase counts are kept over reset in ring mode, and in fixed mode if the last sector has a spare page for them
+    bool isEraseCountPersistent() const { return ringMode || numWearEntries > 0; }
+    // copy of stats, which are updated by service() in background
+    FlashStats getStats() const {
+        backend.lock();
+        const FlashStats copy = stats;
+        backend.unlock();
+        return copy;
+    }
+    void resetStats() {
+        backend.lock();
+        stats = FlashStats();
+        backend.unlock();
+    }
+    uint32_t getRegionOfs() const { return userFlashOfs; }
+    size_t getRegionSize() const { return regionSize; }
+    size_t getImageSize() const { return userReqSize; }
 
 protected:
     // PICO_FLASH_SIZE_BYTES: from pico-sdk/src/boards/include/boards/*.h
     // FLASH_xxx_SIZE       : from pico-sdk/src/rp2_common/hardware_flash/include/hardware/flash.h
-    static constexpr size_t UserReqSize = 1024; // Byte
-    static constexpr size_t EraseSize = ((UserReqSize + (FLASH_SECTOR_SIZE - 1)) / FLASH_SECTOR_SIZE) * FLASH_SECTOR_SIZE;
-    static constexpr size_t PageProgSize = ((UserReqSize + (FLASH_PAGE_SIZE - 1)) / FLASH_PAGE_SIZE) * FLASH_PAGE_SIZE;
-    static constexpr uint32_t UserFlashOfs = PICO_FLASH_SIZE_BYTES - EraseSize;
-    UserFlash();
-    virtual ~UserFlash();
+    //                        (or FlashBackend.h for emulated flash)
+    static constexpr bool XipRead = FLASH_PARAM_XIP_READ;
+    static constexpr bool CrcCheck = FLASH_PARAM_CRC;
+    static constexpr uint32_t RecordMagic = 0x50524d46;  // "FMRP"
+    static constexpr uint32_t CommitMarker = 0x54494d43;  // "CMIT"
+    static constexpr int NoSlot = -1;
+    // instances which exist, to reject overlapping regions
+    static std::vector<const UserFlash*>& _instances();
+    // geometry of the region
+    static constexpr size_t _roundUp(const size_t& size, const size_t& unit) { return ((size + (unit - 1)) / unit) * unit; }
+    static constexpr size_t _pageProgSizeOf(const UserFlashRegion& region) { return _roundUp(region.size, FLASH_PAGE_SIZE); }
+    // fixed mode: the image (and the page of CRC entries) spanning one or more sectors, each of which is erased only if needed
+    static constexpr size_t _eraseSizeOf(const UserFlashRegion& region) {
+        return _roundUp(_pageProgSizeOf(region) + (CrcCheck ? FLASH_PAGE_SIZE : 0), FLASH_SECTOR_SIZE);
+    }
+    // log-structured ring: each record consists of the image and a trailer page programmed after the image
+    //   records are packed into a block of one sector, or of the sectors to hold a record exceeding a sector
+    static constexpr size_t _blockSectorsOf(const UserFlashRegion& region) {
+        return _roundUp(_pageProgSizeOf(region) + FLASH_PAGE_SIZE, FLASH_SECTOR_SIZE) / FLASH_SECTOR_SIZE;
+    }
+    static constexpr size_t _regionSizeOf(const UserFlashRegion& region) {
+        return (region.ringSectors > 0) ? region.ringSectors * FLASH_SECTOR_SIZE : _eraseSizeOf(region);
+    }
+    static constexpr uint32_t _regionOfsOf(const UserFlashRegion& region) {
+        return (region.ofs != 0) ? region.ofs : PICO_FLASH_SIZE_BYTES - _regionSizeOf(region);
+    }
+    struct RecordTrailer {
+        uint32_t magic;
+        uint32_t seq;         // sequence number of the record, the largest one is the newest
+        uint32_t eraseCount;  // erase count of the sector which holds the record
+        uint32_t crc;         // CRC32 of the image (0xffffffff if not FLASH_PARAM_CRC)
+        uint32_t commit;      // CommitMarker programmed at last, after the image and the other fields are complete
+    };
+    // fixed mode: CRC entries are appended into the page after the image, so that the image can be updated without erase
+    struct CrcEntry {
+        uint32_t crc;
+        uint32_t inv;  // ~crc to distinguish from blank and partially programmed entry
+    };
+    static constexpr size_t NumCrcEntries = FLASH_PAGE_SIZE / sizeof(CrcEntry);
     UserFlash(const UserFlash&) = delete;
     UserFlash& operator=(const UserFlash&) = delete;
+    void _loadImage();
+    bool _isImageModified(const uint8_t* image) const;
     void _programCore();
+    void _programRingCore();
+    void _scanRing();
+    int _findNextSlot() const;
+    uint32_t _slotOfs(const int& slot) const;
+    const RecordTrailer* _getTrailer(const int& slot) const;
+    bool _isValidSlot(const int& slot) const;
+    bool _isCrcValid(const uint8_t* image, const uint32_t& crc) const;
+    void _checkFixedCrc();
+    size_t _findNextCrcEntry() const;
+    void _appendCrcEntry(const size_t& index);
+    bool _isEraseNeeded(const size_t& sector, const size_t& crcEntry) const;
+    void _loadWearEntry();
+    size_t _findNextWearEntry() const;
+    void _appendWearEntry(const size_t& index);
+    void _appendStoreTick();
+    bool _safeProgram(const uint64_t& startUs);
+    void _erase(const uint32_t& flash_ofs, const size_t& size);
+    void _program(const uint32_t& flash_ofs, const uint8_t* data, const size_t& size);
+    bool _isBlank(const uint32_t& ofs, const size_t& size) const;
+    bool _isPageModified(const uint32_t& page_ofs) const;
+    void _programPages(const uint32_t& flash_ofs, bool modifiedOnly);
+    static bool _isClearOnly(const uint8_t* image, const uint8_t* flash, const size_t& size);
+    static bool _isErased(const uint8_t* ptr, const size_t& size);
     void _printValue(const char* name, int value, bool decimal = false);
-    const uint8_t* flashContents = reinterpret_cast<const uint8_t*>(XIP_BASE + UserFlashOfs);
-    std::array<uint8_t, PageProgSize> data;
+    const uint8_t* _getReadAddr(const uint32_t& ofs) const { return backend.getReadAddr(userFlashOfs + ofs); }
+    FlashBackend& backend;
+    const char* const name;
+    const size_t userReqSize;
+    const size_t pageProgSize;
+    const bool ringMode;
+    const size_t eraseSize;
+    const size_t recordSize;
+    const size_t blockSectors;
+    const size_t blockSize;
+    const size_t slotsPerBlock;
+    const size_t numSectors;
+    const size_t numSlots;
+    const size_t regionSize;
+    const uint32_t userFlashOfs;
+    // fixed mode: erase counts of all sectors followed by ~CRC32 of them are appended as an entry
+    //   into the spare page after the image (and the page of CRC entries) whenever any sector is erased
+    const uint32_t wearOfs;
+    const size_t wearEntrySize;
+    const size_t numWearEntries;  // 0 if no spare page (erase counts are on RAM only)
+    // fixed mode: store ticks in the page after erase count entries
+    const uint32_t tickOfs;
+    const size_t numStoreTicks;  // 0 if no spare page (every store counts up CFG_STORE_COUNT in the image)
+    const uint8_t* flashContents = nullptr;  // nullptr if no valid record
+    std::vector<uint8_t> data;  // staged image (empty until the first finalize() if XipRead)
+    const uint8_t* programImage = nullptr;  // image to be programmed by _programCore()
+    bool programTick = false;  // _programCore() clears a bit of store ticks instead of erasing them
+    // asynchronous program (shared with the context calling service() under backend.lock())
+    std::vector<uint8_t> requestImage;  // copy of the image requested by programAsync()
+    std::vector<uint8_t> commitImage;   // image being programmed by service()
+    bool requested = false;
+    bool inProgress = false;
+    bool requestTick = false;
+    commit_callback_t requestCallback = nullptr;
+    void* requestContext = nullptr;
+    CommitResult_t lastResult = COMMIT_SUCCESS;
+    int currentSlot = NoSlot;  // slot of the newest record (ring mode only)
+    uint32_t currentSeq = 0;  // the largest sequence number on flash (ring mode only)
+    uint32_t crcErrorCount = 0;  // number of images rejected by CRC error on the last load
+    std::vector<uint32_t> eraseCounts;
+    FlashStats stats;
 
     friend void _user_flash_program_core(void*);
     friend class FlashParam;
 };
+
+static_assert(UserFlash::isValidRegion(UserFlash::DefaultRegion), "invalid FLASH_PARAM_SIZE, FLASH_PARAM_OFFSET or FLASH_PARAM_RING_SECTORS");
 }
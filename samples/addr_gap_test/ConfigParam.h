@@ -8,7 +8,7 @@
 
 #pragma once
 
-#include "FlashParam.h"
+#include "ParamLayout.h"
 
 typedef enum {
     CFG_STRING = FlashParamNs::CFG_ID_BASE,
@@ -34,18 +34,34 @@ struct ConfigParam : FlashParamNs::FlashParam {
         static ConfigParam instance;
         return instance;
     }
-    // Parameter<T>                      instance         id           name         addr      default    size
-    FlashParamNs::Parameter<std::string> P_CFG_STRING    {CFG_STRING, "CFG_STRING",          "abcdefg", 16};
-    FlashParamNs::Parameter<bool>        P_CFG_BOOL      {CFG_BOOL,   "CFG_BOOL",            false};
-    FlashParamNs::Parameter<uint8_t>     P_CFG_UINT8     {CFG_UINT8,  "CFG_UINT8",           23};
-    FlashParamNs::Parameter<uint16_t>    P_CFG_UINT16    {CFG_UINT16, "CFG_UINT16",          4096};
-    // set address gap here. constructor needs size argument as well
-    FlashParamNs::Parameter<uint32_t>    P_CFG_UINT32    {CFG_UINT32, "CFG_UINT32", 0x200UL, 65535*4,   sizeof(uint32_t)};
-    FlashParamNs::Parameter<uint64_t>    P_CFG_UINT64    {CFG_UINT64, "CFG_UINT64",          1ULL<<40};
-    FlashParamNs::Parameter<int8_t>      P_CFG_INT8      {CFG_INT8,   "CFG_INT8",            -16};
-    FlashParamNs::Parameter<int16_t>     P_CFG_INT16     {CFG_INT16,  "CFG_INT16",           -2047};
-    FlashParamNs::Parameter<int32_t>     P_CFG_INT32     {CFG_INT32,  "CFG_INT32",           -65536*5};
-    FlashParamNs::Parameter<int64_t>     P_CFG_INT64     {CFG_INT64,  "CFG_INT64",           -(1LL<<35)};
-    FlashParamNs::Parameter<float>       P_CFG_FLOAT     {CFG_FLOAT,  "CFG_FLOAT",           3.326f};
-    FlashParamNs::Parameter<double>      P_CFG_DOUBLE    {CFG_DOUBLE, "CFG_DOUBLE",          -1.056e-8};
+    // flash address is resolved and checked (overlap, overflow) at compile time
+    //                               type         id          addr     size
+    using Layout = FlashParamNs::Layout<
+        FlashParamNs::Item  <std::string, CFG_STRING,          16>,
+        FlashParamNs::Item  <bool,        CFG_BOOL>,
+        FlashParamNs::Item  <uint8_t,     CFG_UINT8>,
+        FlashParamNs::Item  <uint16_t,    CFG_UINT16>,
+        // set address gap here
+        FlashParamNs::ItemAt<uint32_t,    CFG_UINT32, 0x200UL>,
+        FlashParamNs::Item  <uint64_t,    CFG_UINT64>,
+        FlashParamNs::Item  <int8_t,      CFG_INT8>,
+        FlashParamNs::Item  <int16_t,     CFG_INT16>,
+        FlashParamNs::Item  <int32_t,     CFG_INT32>,
+        FlashParamNs::Item  <int64_t,     CFG_INT64>,
+        FlashParamNs::Item  <float,       CFG_FLOAT>,
+        FlashParamNs::Item  <double,      CFG_DOUBLE>
+    >;
+    // Parameter<T>                      instance         item                          name          default
+    FlashParamNs::Parameter<std::string> P_CFG_STRING    {Layout::item<CFG_STRING>(), "CFG_STRING", "abcdefg"};
+    FlashParamNs::Parameter<bool>        P_CFG_BOOL      {Layout::item<CFG_BOOL>(),   "CFG_BOOL",   false};
+    FlashParamNs::Parameter<uint8_t>     P_CFG_UINT8     {Layout::item<CFG_UINT8>(),  "CFG_UINT8",  23};
+    FlashParamNs::Parameter<uint16_t>    P_CFG_UINT16    {Layout::item<CFG_UINT16>(), "CFG_UINT16", 4096};
+    FlashParamNs::Parameter<uint32_t>    P_CFG_UINT32    {Layout::item<CFG_UINT32>(), "CFG_UINT32", 65535*4};
+    FlashParamNs::Parameter<uint64_t>    P_CFG_UINT64    {Layout::item<CFG_UINT64>(), "CFG_UINT64", 1ULL<<40};
+    FlashParamNs::Parameter<int8_t>      P_CFG_INT8      {Layout::item<CFG_INT8>(),   "CFG_INT8",   -16};
+    FlashParamNs::Parameter<int16_t>     P_CFG_INT16     {Layout::item<CFG_INT16>(),  "CFG_INT16",  -2047};
+    FlashParamNs::Parameter<int32_t>     P_CFG_INT32     {Layout::item<CFG_INT32>(),  "CFG_INT32",  -65536*5};
+    FlashParamNs::Parameter<int64_t>     P_CFG_INT64     {Layout::item<CFG_INT64>(),  "CFG_INT64",  -(1LL<<35)};
+    FlashParamNs::Parameter<float>       P_CFG_FLOAT     {Layout::item<CFG_FLOAT>(),  "CFG_FLOAT",  3.326f};
+    FlashParamNs::Parameter<double>      P_CFG_DOUBLE    {Layout::item<CFG_DOUBLE>(), "CFG_DOUBLE", -1.056e-8};
 };
@@ -0,0 +1,52 @@
+/*-----------------------------------------------------------/
+/ Benchmark.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdio>
+
+//=================================
+// Benchmark helpers
+//=================================
+namespace Benchmark {
+static constexpr int Repeat = 7;  // median of Repeat runs is reported
+// typical flash timing of W25Q16JV (Raspberry Pi Pico) to estimate time on device
+static constexpr double SectorEraseMsec = 45.0;
+static constexpr double PageProgramMsec = 0.4;
+
+// returns median of elapsed time per iteration in nsec
+template <typename F>
+double measure(const int& iterations, F&& func)
+{
+    std::array<double, Repeat> results;
+    func();  // warm up
+    for (auto& result : results) {
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < iterations; i++) {
+            func();
+        }
+        const auto end = std::chrono::steady_clock::now();
+        result = std::chrono::duration<double, std::nano>(end - start).count() / iterations;
+    }
+    std::sort(results.begin(), results.end());
+    return results.at(Repeat / 2);
+}
+
+inline void printHeader(const char* title)
+{
+    printf("\r\n### %s\r\n", title);
+}
+
+inline void printResult(const char* name, const double& nsec, const char* extra = "")
+{
+    printf("%-40s %12.1f ns %s\r\n", name, nsec, extra);
+}
+}
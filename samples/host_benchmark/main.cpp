@@ -0,0 +1,601 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+
+#include "Benchmark.h"
+#include "Crc32.h"
+#include "EmuFlashBackend.h"
+#include "FlashParam.h"
+
+using FlashParamNs::Parameter;
+using Text_t = FlashParamNs::FixedString<32>;
+using Counter_t = FlashParamNs::Counter<60>;
+
+//=================================
+// Parameters under test
+//=================================
+struct BenchParam : FlashParamNs::FlashParam {
+    static BenchParam& instance()  // Singleton
+    {
+        static BenchParam instance;
+        return instance;
+    }
+    // parameters are added at runtime to vary the number of parameters
+    template <typename T>
+    void add(const T& defaultValue) {
+        const uint32_t id = FlashParamNs::CFG_ID_BASE + count++;
+        names.push_back(std::make_unique<std::string>("CFG_" + std::to_string(id)));
+        std::get<std::vector<std::unique_ptr<Parameter<T>>>>(params).push_back(std::make_unique<Parameter<T>>(id, names.back()->c_str(), defaultValue));
+    }
+    template <typename T>
+    Parameter<T>& get(const size_t& i) { return *std::get<std::vector<std::unique_ptr<Parameter<T>>>>(params).at(i); }
+    uint32_t count = 0;
+    std::vector<std::unique_ptr<std::string>> names;
+    std::tuple<
+        std::vector<std::unique_ptr<Parameter<uint8_t>>>,
+        std::vector<std::unique_ptr<Parameter<uint32_t>>>,
+        std::vector<std::unique_ptr<Parameter<float>>>,
+        std::vector<std::unique_ptr<Parameter<double>>>,
+        std::vector<std::unique_ptr<Parameter<uint64_t>>>,
+        std::vector<std::unique_ptr<Parameter<Text_t>>>
+    > params;
+};
+
+// partition in fixed mode to count erases per increment regardless of FLASH_PARAM_RING_SECTORS
+struct CounterParam : FlashParamNs::FlashParam {
+    static CounterParam& instance()  // Singleton
+    {
+        static CounterParam instance;
+        return instance;
+    }
+    static constexpr FlashParamNs::UserFlashRegion Region = {"counter", PICO_FLASH_SIZE_BYTES - 0x10000, 256, 0};
+    static_assert(FlashParamNs::UserFlash::isValidRegion(Region), "invalid region");
+    CounterParam() : FlashParam(Region) {}
+    Parameter<uint32_t>  P_CFG_COUNT   {params, FlashParamNs::CFG_ID_BASE + 0, "CFG_COUNT",   0};
+    Parameter<Counter_t> P_CFG_COUNTER {params, FlashParamNs::CFG_ID_BASE + 1, "CFG_COUNTER", 0};
+};
+
+// partition holding a calibration table of 16 entries as separate parameters and as an aggregate parameter
+struct TableParam : FlashParamNs::FlashParam {
+    static TableParam& instance()  // Singleton
+    {
+        static TableParam instance;
+        return instance;
+    }
+    static constexpr size_t NumEntries = 16;
+    struct Calib {
+        float gain;
+        int16_t offset;
+        uint16_t flags;
+    };
+    static constexpr FlashParamNs::UserFlashRegion Region = {"table", PICO_FLASH_SIZE_BYTES - 0x20000, 256, 0};
+    static_assert(FlashParamNs::UserFlash::isValidRegion(Region), "invalid region");
+    TableParam() : FlashParam(Region) {
+        for (size_t i = 0; i < NumEntries; i++) {
+            names.push_back(std::make_unique<std::string>("CFG_ENTRY_" + std::to_string(i)));
+            entries.push_back(std::make_unique<Parameter<float>>(params, FlashParamNs::CFG_ID_BASE + 2 + i, names.back()->c_str(), 1.0f));
+        }
+    }
+    Parameter<std::array<float, NumEntries>> P_CFG_TABLE {params, FlashParamNs::CFG_ID_BASE + 0, "CFG_TABLE", {}};
+    Parameter<Calib>                         P_CFG_CALIB {params, FlashParamNs::CFG_ID_BASE + 1, "CFG_CALIB", {1.0f, 0, 0}};
+    std::vector<std::unique_ptr<std::string>> names;
+    std::vector<std::unique_ptr<Parameter<float>>> entries;
+};
+
+static void _addParams(BenchParam& benchParam, const uint32_t& total)
+{
+    // mixed types: 1 + 4 + 4 + 8 = 17 bytes for every 4 parameters
+    while (benchParam.count < total) {
+        switch (benchParam.count % 4) {
+            case 0: benchParam.add<uint8_t>(benchParam.count); break;
+            case 1: benchParam.add<uint32_t>(benchParam.count); break;
+            case 2: benchParam.add<float>(benchParam.count * 0.5f); break;
+            default: benchParam.add<double>(benchParam.count * 0.25); break;
+        }
+    }
+}
+
+// names of the parameters added by _addParams() ("CFG_<id>") built at compile time for NameIndex<>
+template <size_t N>
+struct BenchNames {
+    char text[N][12] = {};
+    FlashParamNs::NameEntry entries[N] = {};
+    constexpr BenchNames() {
+        for (size_t i = 0; i < N; i++) {
+            const uint32_t id = FlashParamNs::CFG_ID_BASE + i;
+            char digits[10] = {};
+            size_t numDigits = 0;
+            for (uint32_t v = id; v > 0 || numDigits == 0; v /= 10) { digits[numDigits++] = '0' + v % 10; }
+            size_t len = 0;
+            for (const char c : {'C', 'F', 'G', '_'}) { text[i][len++] = c; }
+            while (numDigits > 0) { text[i][len++] = digits[--numDigits]; }
+            entries[i] = {std::string_view(text[i], len), id};
+        }
+    }
+};
+static constexpr BenchNames<232> benchNames;
+static constexpr FlashParamNs::NameIndex benchNameIndex{benchNames.entries};
+
+//=================================
+// Benchmarks
+//=================================
+static void _benchInitialize(BenchParam& benchParam)
+{
+    Benchmark::printHeader("initialize() vs number of parameters");
+    for (const uint32_t total : {16, 32, 64, 128, 232}) {
+        _addParams(benchParam, total);
+        benchParam.finalize();  // make flash contents valid to load all parameters
+        char name[64];
+        snprintf(name, sizeof(name), "initialize (%d params)", static_cast<int>(total + 2));
+        Benchmark::printResult(name, Benchmark::measure(1000, [&]() { benchParam.initialize(); }));
+    }
+}
+
+static void _benchFinalize(BenchParam& benchParam)
+{
+    auto& emuFlash = FlashParamNs::EmuFlashBackend::instance();
+    Benchmark::printHeader("finalize() latency and flash access per call");
+    auto& param = benchParam.get<uint32_t>(0);
+    const auto scenario = [&](const char* name, auto&& func) {
+        emuFlash.resetCounters();
+        constexpr int iterations = 100;
+        const auto nsec = Benchmark::measure(iterations, func);
+        const auto calls = iterations * Benchmark::Repeat + 1;
+        const double estMsec = (emuFlash.getEraseCount() * Benchmark::SectorEraseMsec + emuFlash.getProgramCount() * Benchmark::PageProgramMsec) / calls;
+        char extra[128];
+        snprintf(extra, sizeof(extra), "erase %6.1f B, program %6.1f B, est. %6.2f ms on device",
+            static_cast<double>(emuFlash.getEraseBytes()) / calls, static_cast<double>(emuFlash.getProgramBytes()) / calls, estMsec);
+        Benchmark::printResult(name, nsec, extra);
+    };
+    scenario("finalize (unchanged)", [&]() { benchParam.finalize(); });
+    scenario("finalize (1 parameter changed)", [&]() {
+        param.set(param.get() + 1);
+        benchParam.finalize();
+    });
+    // erase only when all bits have been cleared (every 33 calls), otherwise programmed in place with a store tick (fixed mode)
+    scenario("finalize (clear a bit of flags)", [&]() {
+        const uint32_t value = param.get();
+        param.set((value == 0) ? 0xffffffffUL : value & (value - 1));
+        benchParam.finalize();
+    });
+    bool toggle = false;
+    scenario("finalize (toggle default / modified)", [&]() {
+        toggle = !toggle;
+        if (toggle) {
+            param.set(param.get() + 1);
+        } else {
+            benchParam.loadDefault(true);
+        }
+        benchParam.finalize();
+    });
+}
+
+static void _benchFinalizeAsync(BenchParam& benchParam)
+{
+    auto& emuFlash = FlashParamNs::EmuFlashBackend::instance();
+    Benchmark::printHeader("finalize() vs finalizeAsync() caller latency (emulated flash timing)");
+    auto& param = benchParam.get<uint32_t>(0);
+    emuFlash.setDelay(static_cast<uint32_t>(Benchmark::SectorEraseMsec * 1000), static_cast<uint32_t>(Benchmark::PageProgramMsec * 1000));
+    Benchmark::printResult("finalize (1 parameter changed)", Benchmark::measure(2, [&]() {
+        param.set(param.get() + 1);
+        benchParam.finalize();
+    }));
+
+    // worker thread in place of core1 or a task of RTOS
+    std::atomic<bool> stop{false};
+    std::thread worker([&]() {
+        while (!stop) {
+            if (!benchParam.serviceFinalize()) {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+        }
+    });
+    struct Results {
+        std::atomic<int> success{0};
+        std::atomic<int> failure{0};
+        std::atomic<int> superseded{0};
+    } results;
+    const auto callback = [](FlashParamNs::CommitResult_t result, void* context) {
+        auto& results = *static_cast<Results*>(context);
+        if (result == FlashParamNs::COMMIT_SUCCESS) {
+            results.success++;
+        } else if (result == FlashParamNs::COMMIT_FAILURE) {
+            results.failure++;
+        } else {
+            results.superseded++;
+        }
+    };
+    const auto nsec = Benchmark::measure(100, [&]() {
+        param.set(param.get() + 1);
+        benchParam.finalizeAsync(callback, &results);
+    });
+    while (benchParam.isFinalizing()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    stop = true;
+    worker.join();
+    emuFlash.setDelay(0, 0);
+    char extra[128];
+    snprintf(extra, sizeof(extra), "success %d, failure %d, superseded %d", results.success.load(), results.failure.load(), results.superseded.load());
+    Benchmark::printResult("finalizeAsync (1 parameter changed)", nsec, extra);
+}
+
+static void _benchAutoCommit(BenchParam& benchParam)
+{
+    auto& emuFlash = FlashParamNs::EmuFlashBackend::instance();
+    Benchmark::printHeader("finalize() per set() vs auto commit (UI knob bursts on virtual clock)");
+    auto& param = benchParam.get<uint32_t>(0);
+    // 20 bursts of 50 steps every 20 ms with 3 sec idle in between, serviced every 10 ms
+    constexpr int Bursts = 20;
+    constexpr int Steps = 50;
+    constexpr uint32_t StepMs = 20;
+    constexpr uint32_t IdleMs = 3000;
+    constexpr uint32_t ServiceMs = 10;
+    const auto scenario = [&](const char* name, const bool autoCommit, const FlashParamNs::AutoCommitConfig& config) {
+        benchParam.finalize();
+        emuFlash.resetCounters();
+        if (autoCommit) { benchParam.enableAutoCommit(config); }
+        const auto statsBefore = benchParam.getAutoCommitStats();
+        uint32_t nowMs = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int burst = 0; burst < Bursts; burst++) {
+            for (int step = 0; step < Steps; step++) {
+                param.set(param.get() + 1);
+                if (!autoCommit) { benchParam.finalize(); }
+                for (uint32_t t = 0; t < StepMs; t += ServiceMs) {
+                    benchParam.serviceAutoCommit(nowMs += ServiceMs);
+                }
+            }
+            for (uint32_t t = 0; t < IdleMs; t += ServiceMs) {
+                benchParam.serviceAutoCommit(nowMs += ServiceMs);
+            }
+        }
+        const auto end = std::chrono::steady_clock::now();
+        benchParam.disableAutoCommit();
+        const auto& stats = benchParam.getAutoCommitStats();
+        const int commits = autoCommit ? static_cast<int>(stats.commits - statsBefore.commits) : Bursts * Steps;
+        const double estMsec = emuFlash.getEraseCount() * Benchmark::SectorEraseMsec + emuFlash.getProgramCount() * Benchmark::PageProgramMsec;
+        char extra[128];
+        snprintf(extra, sizeof(extra), "commits %4d / %d set(), erase %7d B, est. %8.1f ms on device",
+            commits, Bursts * Steps, static_cast<int>(emuFlash.getEraseBytes()), estMsec);
+        Benchmark::printResult(name, std::chrono::duration<double, std::nano>(end - start).count() / (Bursts * Steps), extra);
+    };
+    FlashParamNs::AutoCommitConfig config;
+    scenario("finalize per set()", false, config);
+    config.quietMs = 500;
+    config.maxDelayMs = 0;
+    scenario("auto (quiet 500 ms)", true, config);
+    config.maxDelayMs = 400;
+    scenario("auto (quiet 500 ms, max delay 400 ms)", true, config);
+    config.maxDelayMs = 0;
+    config.maxPending = 16;
+    scenario("auto (quiet 500 ms, max pending 16)", true, config);
+}
+
+static void _benchAccessor(BenchParam& benchParam)
+{
+    Benchmark::printHeader("accessor per call");
+    constexpr int iterations = 100000;
+    const uint32_t idU32 = FlashParamNs::CFG_ID_BASE + 1;
+    const uint32_t idDouble = FlashParamNs::CFG_ID_BASE + 3;
+    auto& param = benchParam.get<uint32_t>(0);
+    volatile uint32_t sinkU32 = 0;
+    volatile double sinkDouble = 0;
+    Benchmark::printResult("Parameter<uint32_t>::get()", Benchmark::measure(iterations, [&]() { sinkU32 = param.get(); }));
+    Benchmark::printResult("Parameter<uint32_t>::set()", Benchmark::measure(iterations, [&]() { param.set(sinkU32 + 1); }));
+    Benchmark::printResult("getValue<uint32_t>(id)", Benchmark::measure(iterations, [&]() { sinkU32 = benchParam.getValue<uint32_t>(idU32); }));
+    Benchmark::printResult("setValue<uint32_t>(id)", Benchmark::measure(iterations, [&]() { benchParam.setValue<uint32_t>(idU32, sinkU32 + 1); }));
+    Benchmark::printResult("getValue<double>(id)", Benchmark::measure(iterations, [&]() { sinkDouble = benchParam.getValue<double>(idDouble); }));
+    Benchmark::printResult("setValue<double>(id)", Benchmark::measure(iterations, [&]() { benchParam.setValue<double>(idDouble, sinkDouble + 1.0); }));
+}
+
+static void _benchName(BenchParam& benchParam)
+{
+    char title[128];
+    snprintf(title, sizeof(title), "lookup by name (%d names, cycling all names)", static_cast<int>(benchNameIndex.size()));
+    Benchmark::printHeader(title);
+    benchParam.setNameIndex(benchNameIndex);
+    constexpr size_t N = benchNameIndex.size();
+    size_t i = 0;
+    volatile uint32_t sinkId = 0;
+    // linear scan with strcmp over the names of the parameters
+    Benchmark::printResult("linear scan (strcmp)", Benchmark::measure(N * 100, [&]() {
+        const char* name = benchNames.text[i++ % N];
+        for (size_t j = 0; j < benchParam.names.size(); j++) {
+            if (std::strcmp(benchParam.names[j]->c_str(), name) == 0) { sinkId = FlashParamNs::CFG_ID_BASE + j; break; }
+        }
+    }));
+    Benchmark::printResult("findId (perfect hash)", Benchmark::measure(N * 100, [&]() {
+        uint32_t id;
+        if (benchParam.findId(benchNames.entries[i++ % N].name, id)) { sinkId = id; }
+    }));
+    const auto& nameU32 = benchNames.entries[1].name;
+    volatile uint32_t sinkU32 = 0;
+    Benchmark::printResult("getValue<uint32_t>(name)", Benchmark::measure(100000, [&]() { sinkU32 = benchParam.getValue<uint32_t>(nameU32); }));
+    Benchmark::printResult("setValue<uint32_t>(name)", Benchmark::measure(100000, [&]() { benchParam.setValue<uint32_t>(nameU32, sinkU32 + 1); }));
+}
+
+static void _benchNotify(BenchParam& benchParam)
+{
+    // main loop reacting to the change of parameters set() by e.g. serial command every 100 iterations
+    const size_t numParams = std::get<1>(benchParam.params).size();
+    char title[128];
+    snprintf(title, sizeof(title), "change detection per loop iteration (%d uint32_t parameters, set() every 100 iterations)", static_cast<int>(numParams));
+    Benchmark::printHeader(title);
+    constexpr int Iterations = 100000;
+    constexpr int SetInterval = 100;
+    uint32_t detected = 0;
+    const auto setOne = [&](const int& i) {
+        if (i % SetInterval == 0) {
+            auto& param = benchParam.get<uint32_t>((i / SetInterval) % numParams);
+            param.set(param.get() + 1);
+        }
+    };
+    const auto report = [&](const char* name, const double& nsec) {
+        char extra[64];
+        snprintf(extra, sizeof(extra), "detected %d / %d", static_cast<int>(detected), Iterations / SetInterval);
+        Benchmark::printResult(name, nsec, extra);
+    };
+    // polling: compare every parameter with the copy of the previous iteration
+    std::vector<uint32_t> prev(numParams);
+    for (size_t j = 0; j < numParams; j++) { prev.at(j) = benchParam.get<uint32_t>(j).get(); }
+    const auto poll = [&]() {
+        detected = 0;
+        for (int i = 0; i < Iterations; i++) {
+            setOne(i);
+            for (size_t j = 0; j < numParams; j++) {
+                const auto& value = benchParam.get<uint32_t>(j).get();
+                if (value != prev[j]) { prev[j] = value; detected++; }
+            }
+        }
+    };
+    report("polling get()", Benchmark::measure(1, poll) / Iterations);
+    // observers: callback is called only for the changed parameter
+    std::vector<FlashParamNs::ChangeObserver> observers(numParams, {[](const uint32_t&, void* context) { (*static_cast<uint32_t*>(context))++; }, &detected});
+    for (size_t j = 0; j < numParams; j++) { benchParam.get<uint32_t>(j).subscribe(observers.at(j)); }
+    const auto observe = [&](const bool deferred) {
+        detected = 0;
+        for (int i = 0; i < Iterations; i++) {
+            setOne(i);
+            if (deferred) { benchParam.dispatchChanges(); }
+        }
+    };
+    report("observer (immediate)", Benchmark::measure(1, [&]() { observe(false); }) / Iterations);
+    benchParam.setDeferredNotify(true);
+    report("observer (deferred, dispatch per loop)", Benchmark::measure(1, [&]() { observe(true); }) / Iterations);
+    benchParam.setDeferredNotify(false);
+    for (size_t j = 0; j < numParams; j++) { benchParam.get<uint32_t>(j).unsubscribe(observers.at(j)); }
+}
+
+static void _benchStream(BenchParam& benchParam)
+{
+    char title[128];
+    snprintf(title, sizeof(title), "exportTo() / importFrom() through memory sink / source (%d params)", static_cast<int>(benchParam.count + 2));
+    Benchmark::printHeader(title);
+    struct Buffer {
+        std::vector<uint8_t> data;
+        size_t pos = 0;
+    } buffer;
+    const auto sink = [](const uint8_t* data, const size_t& size, void* context) {
+        auto& buf = *static_cast<Buffer*>(context);
+        buf.data.insert(buf.data.end(), data, data + size);
+        return true;
+    };
+    const auto source = [](uint8_t* data, const size_t& size, void* context) {
+        auto& buf = *static_cast<Buffer*>(context);
+        const size_t n = std::min(size, buf.data.size() - buf.pos);
+        std::copy_n(buf.data.begin() + buf.pos, n, data);
+        buf.pos += n;
+        return n;
+    };
+    for (const auto& [format, label] : {std::make_pair(FlashParamNs::STREAM_BINARY, "binary"), std::make_pair(FlashParamNs::STREAM_TEXT, "text")}) {
+        char name[64];
+        char extra[64];
+        snprintf(name, sizeof(name), "exportTo (%s)", label);
+        const auto nsecExport = Benchmark::measure(100, [&]() {
+            buffer.data.clear();
+            benchParam.exportTo(format, sink, &buffer);
+        });
+        snprintf(extra, sizeof(extra), "%6d B", static_cast<int>(buffer.data.size()));
+        Benchmark::printResult(name, nsecExport, extra);
+        // import the exported values (round trip and validation are checked by host_value_test)
+        FlashParamNs::ImportResult result;
+        snprintf(name, sizeof(name), "importFrom (%s)", label);
+        const auto nsecImport = Benchmark::measure(100, [&]() {
+            buffer.pos = 0;
+            result = benchParam.importFrom(format, source, &buffer);
+        });
+        snprintf(extra, sizeof(extra), "applied %d, rejected %d", static_cast<int>(result.applied), static_cast<int>(result.rejected));
+        Benchmark::printResult(name, nsecImport, extra);
+    }
+}
+
+static void _benchMulticore(BenchParam& benchParam)
+{
+    char title[128];
+    snprintf(title, sizeof(title), "load() on reader under concurrent set() on writer thread (FLASH_PARAM_MULTICORE_SAFE=%d)", FLASH_PARAM_MULTICORE_SAFE);
+    Benchmark::printHeader(title);
+    benchParam.add<uint64_t>(0);
+    benchParam.add<Text_t>("");
+    auto& paramU64 = benchParam.get<uint64_t>(0);
+    auto& paramText = benchParam.get<Text_t>(0);
+    // every value written is self-consistent (both halves equal, all characters equal), then a torn read is detectable
+    const auto isTorn = [](const uint64_t& u64, const Text_t& text) {
+        if ((u64 >> 32) != (u64 & 0xffffffffULL)) { return true; }
+        for (size_t i = 1; i < text.size(); i++) {
+            if (text.c_str()[i] != text.c_str()[0]) { return true; }
+        }
+        return false;
+    };
+    const auto scenario = [&](const char* name, const bool withWriter) {
+        std::atomic<bool> stop{false};
+        std::atomic<uint64_t> writes{0};
+        std::thread writer([&]() {
+            char str[Text_t::capacity() + 1];
+            for (uint32_t i = 1; withWriter && !stop; i++) {
+                std::fill(str, str + Text_t::capacity(), static_cast<char>('a' + i % 26));
+                str[Text_t::capacity()] = '\0';
+                paramU64.set(i * 0x0000000100000001ULL);
+                paramText.set(str);
+                writes++;
+            }
+        });
+        constexpr int Iterations = 1000000;
+        int torn = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < Iterations; i++) {
+            const uint64_t u64 = paramU64.load();
+            const Text_t text = paramText.load();
+            if (isTorn(u64, text)) { torn++; }
+        }
+        const auto end = std::chrono::steady_clock::now();
+        stop = true;
+        writer.join();
+        char extra[128];
+        snprintf(extra, sizeof(extra), "torn %d / %d, writes %lld", torn, Iterations, static_cast<long long>(writes.load()));
+        Benchmark::printResult(name, std::chrono::duration<double, std::nano>(end - start).count() / Iterations, extra);
+    };
+    paramU64.set(0);
+    paramText.set("");
+    scenario("load() x 2 (no writer)", false);
+    scenario("load() x 2 (concurrent writer)", true);
+}
+
+static void _benchCrc()
+{
+    Benchmark::printHeader("CRC32 verification vs image size");
+    std::vector<uint8_t> image(16384);
+    for (size_t i = 0; i < image.size(); i++) { image.at(i) = static_cast<uint8_t>(i * 37 + 5); }
+    volatile uint32_t sink = 0;
+    const auto scenario = [&](const char* kernel, const size_t& size, FlashParamNs::Crc32::kernel_t func) {
+        const auto nsec = Benchmark::measure(1000, [&]() { sink = func(image.data(), size); });
+        char name[64];
+        snprintf(name, sizeof(name), "%s (%d B)", kernel, static_cast<int>(size));
+        char extra[64];
+        snprintf(extra, sizeof(extra), "%7.1f MB/s", size / nsec * 1e3);
+        Benchmark::printResult(name, nsec, extra);
+    };
+    for (const size_t size : {256, 1024, 4096, 16384}) {
+        scenario("bytewise", size, FlashParamNs::Crc32::calcBytewise);
+        scenario("slice-by-4", size, FlashParamNs::Crc32::calcSliceBy4);
+    }
+    // load on boot including CRC verification if FLASH_PARAM_CRC
+    auto& userFlash = FlashParamNs::UserFlash::instance();
+    Benchmark::printResult("UserFlash::reload()", Benchmark::measure(1000, [&]() { userFlash.reload(); }));
+}
+
+static void _benchPrintInfo(BenchParam& benchParam)
+{
+    Benchmark::printHeader("printInfo() (stdout to /dev/null)");
+    fflush(stdout);
+    const int savedFd = dup(fileno(stdout));
+    if (freopen("/dev/null", "w", stdout) == nullptr) { return; }
+    const auto nsec = Benchmark::measure(100, [&]() { benchParam.printInfo(); });
+    fflush(stdout);
+    dup2(savedFd, fileno(stdout));
+    close(savedFd);
+    char name[64];
+    snprintf(name, sizeof(name), "printInfo (%d params)", static_cast<int>(benchParam.count + 2));
+    Benchmark::printResult(name, nsec);
+}
+
+static void _benchCounter()
+{
+    auto& emuFlash = FlashParamNs::EmuFlashBackend::instance();
+    Benchmark::printHeader("increment with finalize() per call in fixed mode: Parameter<uint32_t> vs Parameter<Counter<60>>");
+    auto& counterParam = CounterParam::instance();
+    counterParam.initialize();
+    const auto scenario = [&](const char* name, auto&& func) {
+        emuFlash.resetCounters();
+        constexpr int iterations = 1000;
+        const auto nsec = Benchmark::measure(iterations, [&]() {
+            func();
+            counterParam.finalize();
+        });
+        const auto calls = iterations * Benchmark::Repeat + 1;
+        const auto erases = emuFlash.getEraseCount();
+        const double estMsec = (erases * Benchmark::SectorEraseMsec + emuFlash.getProgramCount() * Benchmark::PageProgramMsec) / calls;
+        char extra[128];
+        snprintf(extra, sizeof(extra), "%8.1f increments per erase, est. %6.2f ms on device",
+            (erases > 0) ? static_cast<double>(calls) / erases : static_cast<double>(calls), estMsec);
+        Benchmark::printResult(name, nsec, extra);
+    };
+    scenario("uint32_t set(get() + 1)", [&]() { counterParam.P_CFG_COUNT.set(counterParam.P_CFG_COUNT.get() + 1); });
+    scenario("Counter<60> increment()", [&]() { counterParam.P_CFG_COUNTER.increment(); });
+}
+
+static void _benchAggregate()
+{
+    Benchmark::printHeader("16 entries: 16 x Parameter<float> vs Parameter<std::array<float, 16>>");
+    auto& tableParam = TableParam::instance();
+    tableParam.initialize();
+    auto& table = tableParam.P_CFG_TABLE;
+    auto& entries = tableParam.entries;
+    float x = 0.0f;
+    Benchmark::printResult("16 x set()", Benchmark::measure(1000, [&]() {
+        x += 1.0f;
+        for (size_t i = 0; i < TableParam::NumEntries; i++) { entries.at(i)->set(x + i); }
+    }));
+    Benchmark::printResult("set(i, element) x 16", Benchmark::measure(1000, [&]() {
+        x += 1.0f;
+        for (size_t i = 0; i < TableParam::NumEntries; i++) { table.set(i, x + i); }
+    }));
+    Benchmark::printResult("set(array)", Benchmark::measure(1000, [&]() {
+        x += 1.0f;
+        std::array<float, TableParam::NumEntries> values;
+        for (size_t i = 0; i < TableParam::NumEntries; i++) { values.at(i) = x + i; }
+        table.set(values);
+    }));
+    tableParam.P_CFG_CALIB.set(&TableParam::Calib::gain, 0.5f);
+    tableParam.finalize();
+    volatile float sink = 0.0f;
+    Benchmark::printResult("16 x getFromFlash()", Benchmark::measure(1000, [&]() {
+        for (const auto& entry : entries) { sink = entry->getFromFlash(); }
+    }));
+    Benchmark::printResult("getFromFlash() (single copy)", Benchmark::measure(1000, [&]() { sink = table.getFromFlash().at(0); }));
+    // round trip through flash and isDirty() per element are checked by host_value_test
+    Benchmark::printResult("initialize() (18 params)", Benchmark::measure(1000, [&]() { tableParam.initialize(); }));
+}
+
+static void _benchStats(BenchParam& benchParam)
+{
+    Benchmark::printHeader("flash stats over the benchmark (getFlashStats())");
+    auto& backend = FlashParamNs::EmuFlashBackend::instance();
+    volatile uint64_t sinkUs = 0;
+    Benchmark::printResult("FlashBackend::getTimeUs()", Benchmark::measure(100000, [&]() { sinkUs = backend.getTimeUs(); }));
+    benchParam.getFlashStats().print();
+}
+
+int main() {
+    BenchParam& benchParam = BenchParam::instance();
+    benchParam.initialize();
+
+    _benchInitialize(benchParam);
+    _benchFinalize(benchParam);
+    _benchFinalizeAsync(benchParam);
+    _benchAutoCommit(benchParam);
+    _benchAccessor(benchParam);
+    _benchName(benchParam);
+    _benchNotify(benchParam);
+    _benchStream(benchParam);
+    _benchCrc();
+    _benchPrintInfo(benchParam);
+    _benchMulticore(benchParam);
+    _benchCounter();
+    _benchAggregate();
+    _benchStats(benchParam);
+
+    return 0;
+}
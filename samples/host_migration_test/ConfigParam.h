@@ -0,0 +1,79 @@
+/*-----------------------------------------------------------/
+/ ConfigParam.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include "FlashParam.h"
+
+// ids are kept over firmware versions
+typedef enum {
+    CFG_VOLUME = FlashParamNs::CFG_ID_BASE,
+    CFG_GAIN,
+    CFG_NAME,
+    CFG_MODE,
+    CFG_BALANCE,  // added in version 2
+} ConfigParamId_t;
+
+//=================================
+// Interface of ConfigParamV1 class
+//=================================
+// parameters of firmware version 1
+struct ConfigParamV1 : FlashParamNs::FlashParam {
+    // the same region as version 2, which is emulated in a process (not a singleton to be destroyed before version 2)
+    ConfigParamV1() : FlashParam(FlashParamNs::UserFlash::DefaultRegion) {}
+    using Name_t = FlashParamNs::FixedString<8>;
+    // Parameter<T>                   instance      params  id          name          default
+    FlashParamNs::Parameter<uint8_t>  P_CFG_VOLUME {params, CFG_VOLUME, "CFG_VOLUME", 50};
+    FlashParamNs::Parameter<float>    P_CFG_GAIN   {params, CFG_GAIN,   "CFG_GAIN",   1.0f};
+    FlashParamNs::Parameter<Name_t>   P_CFG_NAME   {params, CFG_NAME,   "CFG_NAME",   "noname"};
+    FlashParamNs::Parameter<uint16_t> P_CFG_MODE   {params, CFG_MODE,   "CFG_MODE",   0};
+};
+
+//=================================
+// Interface of ConfigParamV2 class
+//=================================
+// parameters of firmware version 2: CFG_BALANCE is added, CFG_NAME is resized and type of CFG_MODE is changed
+struct ConfigParamV2 : FlashParamNs::FlashParam {
+    static ConfigParamV2& instance()  // Singleton
+    {
+        static ConfigParamV2 instance;
+        return instance;
+    }
+    ConfigParamV2() : FlashParam(FlashParamNs::UserFlash::DefaultRegion) {}
+    using Name_t = FlashParamNs::FixedString<16>;
+    // Parameter<T>                   instance       params  id           name           default
+    FlashParamNs::Parameter<uint8_t>  P_CFG_VOLUME  {params, CFG_VOLUME,  "CFG_VOLUME",  50};
+    FlashParamNs::Parameter<int8_t>   P_CFG_BALANCE {params, CFG_BALANCE, "CFG_BALANCE", 0};  // flash address of the following parameters moves
+    FlashParamNs::Parameter<float>    P_CFG_GAIN    {params, CFG_GAIN,    "CFG_GAIN",    1.0f};
+    FlashParamNs::Parameter<Name_t>   P_CFG_NAME    {params, CFG_NAME,    "CFG_NAME",    "noname"};
+    FlashParamNs::Parameter<int16_t>  P_CFG_MODE    {params, CFG_MODE,    "CFG_MODE",    -1};
+};
+
+//=================================
+// Interface of TightParamV1 / V2 class
+//=================================
+// parameters of the small image without room for the schema, which is stored without it
+static constexpr FlashParamNs::UserFlashRegion TightRegion = {"tight", PICO_FLASH_SIZE_BYTES - 0x10000, 64, 0};
+
+struct TightParamV1 : FlashParamNs::FlashParam {
+    TightParamV1() : FlashParam(TightRegion) {}
+    using Name_t = FlashParamNs::FixedString<48>;
+    // Parameter<T>                   instance      params  id          name          default
+    FlashParamNs::Parameter<uint8_t>  P_CFG_VOLUME {params, CFG_VOLUME, "CFG_VOLUME", 50};
+    FlashParamNs::Parameter<Name_t>   P_CFG_NAME   {params, CFG_NAME,   "CFG_NAME",   "noname"};
+};
+
+// CFG_BALANCE is added, then all parameters are loaded with default since the stored image has no schema
+struct TightParamV2 : FlashParamNs::FlashParam {
+    TightParamV2() : FlashParam(TightRegion) {}
+    using Name_t = FlashParamNs::FixedString<48>;
+    // Parameter<T>                   instance       params  id           name           default
+    FlashParamNs::Parameter<uint8_t>  P_CFG_VOLUME  {params, CFG_VOLUME,  "CFG_VOLUME",  50};
+    FlashParamNs::Parameter<int8_t>   P_CFG_BALANCE {params, CFG_BALANCE, "CFG_BALANCE", 0};
+    FlashParamNs::Parameter<Name_t>   P_CFG_NAME    {params, CFG_NAME,    "CFG_NAME",    "noname"};
+};
@@ -0,0 +1,89 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include <cstdio>
+
+#include "ConfigParam.h"
+#include "EmuFlashBackend.h"
+
+using FlashParamNs::EmuFlashBackend;
+
+static bool _check(const char* name, bool result, size_t& failures)
+{
+    printf("%-48s %s\r\n", name, result ? "OK" : "NG");
+    if (!result) { failures++; }
+    return result;
+}
+
+int main() {
+    auto& emuFlash = EmuFlashBackend::instance();
+    emuFlash.blank();
+
+    printf("=== migration test ===\r\n");
+    size_t failures = 0;
+
+    // user settings stored by firmware version 1
+    //   destroyed before version 2 is constructed since regions of existing partitions must not overlap
+    uint32_t storeCount;
+    {
+        ConfigParamV1 v1;
+        v1.initialize();
+        v1.P_CFG_VOLUME.set(77);
+        v1.P_CFG_GAIN.set(0.5f);
+        v1.P_CFG_NAME.set("abc");
+        v1.P_CFG_MODE.set(3);
+        v1.finalize();
+        v1.finalize();  // no change, store count is not incremented
+        v1.P_CFG_VOLUME.set(78);
+        v1.finalize();
+        storeCount = v1.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT);
+    }
+
+    // firmware update to version 2
+    ConfigParamV2& v2 = ConfigParamV2::instance();
+    v2.initialize();
+    v2.printInfo();
+    _check("migrated: CFG_VOLUME", v2.P_CFG_VOLUME.get() == 78, failures);
+    _check("migrated: CFG_GAIN (flash address moved)", v2.P_CFG_GAIN.get() == 0.5f, failures);
+    _check("migrated: CFG_STORE_COUNT", v2.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT) == storeCount, failures);
+    _check("default: CFG_BALANCE (added)", v2.P_CFG_BALANCE.get() == 0, failures);
+    _check("default: CFG_NAME (resized)", v2.P_CFG_NAME.get() == "noname", failures);
+    _check("default: CFG_MODE (type changed)", v2.P_CFG_MODE.get() == -1, failures);
+    _check("migrate count", v2.getMigrateCount() == 3, failures);
+
+    // stored in the schema of version 2, then loaded without migration
+    v2.P_CFG_BALANCE.set(-5);
+    v2.finalize();
+    v2.initialize();
+    _check("reloaded without migration", v2.getMigrateCount() == 0, failures);
+    _check("values kept after update",
+        v2.P_CFG_VOLUME.get() == 78 && v2.P_CFG_GAIN.get() == 0.5f && v2.P_CFG_BALANCE.get() == -5 &&
+        v2.P_CFG_NAME.get() == "noname" && v2.P_CFG_MODE.get() == -1, failures);
+    _check("store count continued", v2.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT) == storeCount + 1, failures);
+
+#if !FLASH_PARAM_SPARSE
+    // the image without room for the schema is stored without it, then loaded with default after the update (no schema with FLASH_PARAM_SPARSE)
+    {
+        TightParamV1 t1;
+        t1.initialize();
+        t1.P_CFG_VOLUME.set(77);
+        t1.P_CFG_NAME.set("abc");
+        t1.finalize();
+        t1.printInfo();
+        t1.initialize();
+        _check("tight: stored without schema", t1.P_CFG_VOLUME.get() == 77 && t1.P_CFG_NAME.get() == "abc", failures);
+    }
+    {
+        TightParamV2 t2;
+        t2.initialize();
+        _check("tight: default without schema", t2.P_CFG_VOLUME.get() == 50 && t2.P_CFG_NAME.get() == "noname", failures);
+        _check("tight: migrate count", t2.getMigrateCount() == 0, failures);
+    }
+#endif
+
+    printf("%s (failure %d)\r\n", (failures == 0) ? "PASS" : "FAIL", static_cast<int>(failures));
+    return (failures == 0) ? 0 : 1;
+}
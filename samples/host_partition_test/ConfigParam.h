@@ -0,0 +1,88 @@
+/*-----------------------------------------------------------/
+/ ConfigParam.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include "FlashParam.h"
+#include "ParamLayout.h"
+
+//=================================
+// Interface of UserParam class
+//=================================
+// frequently changing user settings in the default partition
+typedef enum {
+    USR_VOLUME = FlashParamNs::CFG_ID_BASE,
+    USR_BRIGHTNESS,
+    USR_PRESET,
+} UserParamId_t;
+
+struct UserParam : FlashParamNs::FlashParam {
+    static UserParam& instance()  // Singleton
+    {
+        static UserParam instance;
+        return instance;
+    }
+    //                               type      id
+    using Layout = FlashParamNs::Layout<
+        FlashParamNs::Item<uint8_t,  USR_VOLUME>,
+        FlashParamNs::Item<uint8_t,  USR_BRIGHTNESS>,
+        FlashParamNs::Item<uint16_t, USR_PRESET>
+    >;
+    // Parameter<T>                   instance          item                              name              default
+    FlashParamNs::Parameter<uint8_t>  P_USR_VOLUME     {Layout::item<USR_VOLUME>(),     "USR_VOLUME",     50};
+    FlashParamNs::Parameter<uint8_t>  P_USR_BRIGHTNESS {Layout::item<USR_BRIGHTNESS>(), "USR_BRIGHTNESS", 80};
+    FlashParamNs::Parameter<uint16_t> P_USR_PRESET     {Layout::item<USR_PRESET>(),     "USR_PRESET",     0};
+};
+
+//=================================
+// Interface of CalibParam class
+//=================================
+// rarely changing factory calibration in its own partition (ids are independent of the other partition)
+typedef enum {
+    CAL_SERIAL = FlashParamNs::CFG_ID_BASE,
+    CAL_GAIN_L,
+    CAL_GAIN_R,
+    CAL_OFFSET_L,
+    CAL_OFFSET_R,
+    CAL_TABLE,
+    CAL_COUNT,
+} CalibParamId_t;
+
+struct CalibParam : FlashParamNs::FlashParam {
+    static CalibParam& instance()  // Singleton
+    {
+        static CalibParam instance;
+        return instance;
+    }
+    // 64 KB before the end of flash, apart from the default partition
+    static constexpr FlashParamNs::UserFlashRegion Region = {"calib", PICO_FLASH_SIZE_BYTES - 0x10000, 2048, 0};
+    static_assert(FlashParamNs::UserFlash::isValidRegion(Region), "invalid region");
+    static_assert(!FlashParamNs::UserFlash::isOverlapping(Region, FlashParamNs::UserFlash::DefaultRegion), "region overlaps the default partition");
+    using Serial_t = FlashParamNs::FixedString<16>;
+    using Table_t = std::array<float, 8>;
+    using Count_t = FlashParamNs::Counter<4>;
+    //                                 size         type      id
+    using Layout = FlashParamNs::LayoutOf<Region.size,
+        FlashParamNs::Item  <Serial_t, CAL_SERIAL>,
+        FlashParamNs::ItemAt<double,   CAL_GAIN_L,   0x400UL>,
+        FlashParamNs::Item  <double,   CAL_GAIN_R>,
+        FlashParamNs::Item  <double,   CAL_OFFSET_L>,
+        FlashParamNs::Item  <double,   CAL_OFFSET_R>,
+        FlashParamNs::Item  <Table_t,  CAL_TABLE>,
+        FlashParamNs::Item  <Count_t,  CAL_COUNT>
+    >;
+    CalibParam() : FlashParam(Region) {}
+    // Parameter<T>                   instance        params  item                          name            default
+    FlashParamNs::Parameter<Serial_t> P_CAL_SERIAL   {params, Layout::item<CAL_SERIAL>(),   "CAL_SERIAL",   "unknown"};
+    FlashParamNs::Parameter<double>   P_CAL_GAIN_L   {params, Layout::item<CAL_GAIN_L>(),   "CAL_GAIN_L",   1.0};
+    FlashParamNs::Parameter<double>   P_CAL_GAIN_R   {params, Layout::item<CAL_GAIN_R>(),   "CAL_GAIN_R",   1.0};
+    FlashParamNs::Parameter<double>   P_CAL_OFFSET_L {params, Layout::item<CAL_OFFSET_L>(), "CAL_OFFSET_L", 0.0};
+    FlashParamNs::Parameter<double>   P_CAL_OFFSET_R {params, Layout::item<CAL_OFFSET_R>(), "CAL_OFFSET_R", 0.0};
+    FlashParamNs::Parameter<Table_t>  P_CAL_TABLE    {params, Layout::item<CAL_TABLE>(),    "CAL_TABLE",    {}};
+    FlashParamNs::Parameter<Count_t>  P_CAL_COUNT    {params, Layout::item<CAL_COUNT>(),    "CAL_COUNT",    0};  // times of calibration
+};
@@ -0,0 +1,128 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include <cstdio>
+#include <vector>
+
+#include "ConfigParam.h"
+#include "EmuFlashBackend.h"
+
+using FlashParamNs::EmuFlashBackend;
+
+static bool _check(const char* name, bool result, size_t& failures)
+{
+    printf("%-48s %s\r\n", name, result ? "OK" : "NG");
+    if (!result) { failures++; }
+    return result;
+}
+
+int main() {
+    auto& emuFlash = EmuFlashBackend::instance();
+    emuFlash.blank();
+    UserParam& userParam = UserParam::instance();
+    CalibParam& calibParam = CalibParam::instance();
+    userParam.initialize();
+    calibParam.initialize();
+
+    printf("=== partition test ===\r\n");
+    size_t failures = 0;
+
+    // factory calibration stored once
+    emuFlash.resetCounters();
+    calibParam.P_CAL_SERIAL.set("SN-0123456789");
+    calibParam.P_CAL_GAIN_L.set(1.0125);
+    calibParam.P_CAL_GAIN_R.set(0.9875);
+    calibParam.P_CAL_OFFSET_L.set(-0.003);
+    calibParam.P_CAL_OFFSET_R.set(0.002);
+    calibParam.P_CAL_TABLE.set(3, 0.5f);
+    calibParam.P_CAL_COUNT.increment();
+    calibParam.finalize();
+    printf("calib commit: erase %d B, program %d B\r\n", static_cast<int>(emuFlash.getEraseBytes()), static_cast<int>(emuFlash.getProgramBytes()));
+    const auto calibStoreCount = calibParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT);
+    const auto calibImage = emuFlash.snapshot(CalibParam::Region.ofs, FLASH_SECTOR_SIZE);
+
+    // frequently changing user settings
+    constexpr int NumCommits = 100;
+    emuFlash.resetCounters();
+    for (int i = 0; i < NumCommits; i++) {
+        userParam.P_USR_VOLUME.set(static_cast<uint8_t>(i));
+        userParam.P_USR_PRESET.set(static_cast<uint16_t>(i * 3));
+        userParam.finalize();
+    }
+    printf("user commit: erase %.1f B, program %.1f B per commit\r\n",
+        static_cast<double>(emuFlash.getEraseBytes()) / NumCommits, static_cast<double>(emuFlash.getProgramBytes()) / NumCommits);
+    _check("calib region untouched by user commits", emuFlash.snapshot(CalibParam::Region.ofs, FLASH_SECTOR_SIZE) == calibImage, failures);
+
+    // reboot: each partition is loaded from its own region
+    userParam.initialize();
+    calibParam.initialize();
+    _check("user settings restored",
+        userParam.P_USR_VOLUME.get() == NumCommits - 1 && userParam.P_USR_PRESET.get() == (NumCommits - 1) * 3 &&
+        userParam.P_USR_BRIGHTNESS.get() == 80, failures);
+    _check("calibration restored",
+        calibParam.P_CAL_SERIAL.get() == "SN-0123456789" && calibParam.P_CAL_GAIN_L.get() == 1.0125 &&
+        calibParam.P_CAL_GAIN_R.get() == 0.9875 && calibParam.P_CAL_OFFSET_L.get() == -0.003 &&
+        calibParam.P_CAL_OFFSET_R.get() == 0.002 && calibParam.P_CAL_TABLE.get(3) == 0.5f &&
+        calibParam.P_CAL_COUNT.get() == 1, failures);
+    _check("store count of calib independent of user",
+        calibParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT) == calibStoreCount, failures);
+    _check("map hash of parameters equals Layout<>",
+        calibParam.getValue<uint32_t>(FlashParamNs::CFG_MAP_HASH) == CalibParam::Layout::MapHash &&
+        userParam.getValue<uint32_t>(FlashParamNs::CFG_MAP_HASH) == UserParam::Layout::MapHash, failures);
+    _check("map hash differs by partition",
+        calibParam.getValue<uint32_t>(FlashParamNs::CFG_MAP_HASH) != userParam.getValue<uint32_t>(FlashParamNs::CFG_MAP_HASH), failures);
+
+    // calib finalize() with no change doesn't touch flash nor notify CFG_MAP_HASH
+    int hashNotified = 0;
+    FlashParamNs::ChangeObserver hashObserver{[](const uint32_t&, void* context) { (*static_cast<int*>(context))++; }, &hashNotified};
+    calibParam.subscribe(FlashParamNs::CFG_MAP_HASH, hashObserver);
+    emuFlash.resetCounters();
+    calibParam.finalize();
+    calibParam.unsubscribe(FlashParamNs::CFG_MAP_HASH, hashObserver);
+    _check("calib finalize without change accesses no flash", emuFlash.getEraseBytes() == 0 && emuFlash.getProgramBytes() == 0, failures);
+    _check("calib finalize without change notifies nothing", hashNotified == 0, failures);
+
+    // commits only clearing bits (Counter<N>) are programmed in place without erase, where CFG_STORE_COUNT is counted up by store ticks
+    constexpr int NumIncrements = 8;
+    const auto countBefore = calibParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT);
+    emuFlash.resetCounters();
+    for (int i = 0; i < NumIncrements; i++) {
+        calibParam.P_CAL_COUNT.increment();
+        calibParam.finalize();
+    }
+    calibParam.initialize();
+    const auto countAfter = calibParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT);
+    _check("counter restored after commits clearing bits", calibParam.P_CAL_COUNT.get() == 1 + NumIncrements, failures);
+    _check("commits clearing bits erase nothing", emuFlash.getEraseCount() == 0, failures);
+    _check("store count incremented by every commit", countAfter == countBefore + NumIncrements, failures);
+
+    // overlapping regions are rejected, and the region is available again after the partition is destroyed
+    constexpr FlashParamNs::UserFlashRegion OverlapCalib = {"overlap", CalibParam::Region.ofs, 256, 0};
+    constexpr FlashParamNs::UserFlashRegion OverlapDefault = {"overlap", 0, 256, 0};
+    constexpr FlashParamNs::UserFlashRegion Spare = {"spare", PICO_FLASH_SIZE_BYTES - 0x20000, 256, 1};
+    static_assert(FlashParamNs::UserFlash::isOverlapping(OverlapCalib, CalibParam::Region), "overlap not detected");
+    _check("region overlapping calib rejected", !FlashParamNs::UserFlash::isAvailableRegion(OverlapCalib), failures);
+    _check("region overlapping default rejected", !FlashParamNs::UserFlash::isAvailableRegion(OverlapDefault), failures);
+    _check("spare region available", FlashParamNs::UserFlash::isAvailableRegion(Spare), failures);
+    {
+        FlashParamNs::UserFlash spareFlash(Spare);
+        _check("spare region taken", !FlashParamNs::UserFlash::isAvailableRegion(Spare), failures);
+    }
+    _check("spare region released", FlashParamNs::UserFlash::isAvailableRegion(Spare), failures);
+
+    // parameter constructed without params joins the default partition even after the constructor of the other partition
+    {
+        static FlashParamNs::Parameter<double> P_USR_EXTRA {CAL_OFFSET_L, "USR_EXTRA", 7.5};  // the same id as the calib
+        _check("parameter without params in default partition",
+            userParam.getValue<double>(CAL_OFFSET_L) == 7.5 && calibParam.getValue<double>(CAL_OFFSET_L) == -0.003, failures);
+    }
+
+    userParam.printInfo();
+    calibParam.printInfo();
+
+    printf("%s (failure %d)\r\n", (failures == 0) ? "PASS" : "FAIL", static_cast<int>(failures));
+    return (failures == 0) ? 0 : 1;
+}
@@ -0,0 +1,48 @@
+/*-----------------------------------------------------------/
+/ ConfigParam.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include "FlashParam.h"
+#include "ParamLayout.h"
+
+typedef enum {
+    CFG_GEN = FlashParamNs::CFG_ID_BASE,
+    CFG_NAME,
+    CFG_VALUE_A,
+    CFG_VALUE_B,
+    CFG_TAIL,
+} ParamId_t;
+
+//=================================
+// Interface of ConfigParam class
+//=================================
+// parameters spread over all pages of the image
+struct ConfigParam : FlashParamNs::FlashParam {
+    static ConfigParam& instance()  // Singleton
+    {
+        static ConfigParam instance;
+        return instance;
+    }
+    using Name_t = FlashParamNs::FixedString<32>;
+    // flash address is resolved and checked (overlap, overflow) at compile time
+    //                               type      id           addr
+    using Layout = FlashParamNs::Layout<
+        FlashParamNs::Item  <uint32_t, CFG_GEN>,
+        FlashParamNs::ItemAt<Name_t,   CFG_NAME,    0x100UL>,
+        FlashParamNs::ItemAt<uint64_t, CFG_VALUE_A, 0x200UL>,
+        FlashParamNs::ItemAt<uint64_t, CFG_VALUE_B, 0x300UL>,
+        FlashParamNs::ItemAt<uint32_t, CFG_TAIL,    0x3fcUL>
+    >;
+    // Parameter<T>                   instance       item                           name           default
+    FlashParamNs::Parameter<uint32_t> P_CFG_GEN     {Layout::item<CFG_GEN>(),     "CFG_GEN",     0};
+    FlashParamNs::Parameter<Name_t>   P_CFG_NAME    {Layout::item<CFG_NAME>(),    "CFG_NAME",    "default"};
+    FlashParamNs::Parameter<uint64_t> P_CFG_VALUE_A {Layout::item<CFG_VALUE_A>(), "CFG_VALUE_A", 0};
+    FlashParamNs::Parameter<uint64_t> P_CFG_VALUE_B {Layout::item<CFG_VALUE_B>(), "CFG_VALUE_B", 0};
+    FlashParamNs::Parameter<uint32_t> P_CFG_TAIL    {Layout::item<CFG_TAIL>(),    "CFG_TAIL",    0};
+};
@@ -0,0 +1,217 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include <cstdio>
+#include <vector>
+
+#include "ConfigParam.h"
+#include "EmuFlashBackend.h"
+
+using FlashParamNs::EmuFlashBackend;
+using FlashParamNs::UserFlash;
+
+// a single block ring erases the newest record before appending the next one
+static_assert(UserFlash::isPowerFailSafe(UserFlash::DefaultRegion), "FLASH_PARAM_RING_SECTORS must be 2 blocks or more");
+
+// values of all parameters are derived from the generation number
+static void _setGeneration(ConfigParam& cfgParam, const uint32_t& gen)
+{
+    char name[33];
+    snprintf(name, sizeof(name), "generation-%u", static_cast<unsigned int>(gen));
+    const uint64_t value = gen * 0x9e3779b97f4a7c15ULL;
+    cfgParam.P_CFG_GEN.set(gen);
+    cfgParam.P_CFG_NAME.set(name);
+    cfgParam.P_CFG_VALUE_A.set(value);
+    cfgParam.P_CFG_VALUE_B.set(~value);
+    cfgParam.P_CFG_TAIL.set(gen ^ 0xa5a5a5a5UL);
+}
+
+static bool _isGeneration(ConfigParam& cfgParam, const uint32_t& gen)
+{
+    char name[33];
+    snprintf(name, sizeof(name), "generation-%u", static_cast<unsigned int>(gen));
+    const uint64_t value = gen * 0x9e3779b97f4a7c15ULL;
+    return cfgParam.P_CFG_GEN.get() == gen &&
+           cfgParam.P_CFG_NAME.get() == name &&
+           cfgParam.P_CFG_VALUE_A.get() == value &&
+           cfgParam.P_CFG_VALUE_B.get() == ~value &&
+           cfgParam.P_CFG_TAIL.get() == (gen ^ 0xa5a5a5a5UL);
+}
+
+static bool _isDefault(ConfigParam& cfgParam)
+{
+    return cfgParam.P_CFG_GEN.get() == cfgParam.P_CFG_GEN.getDefault() &&
+           cfgParam.P_CFG_NAME.get() == cfgParam.P_CFG_NAME.getDefault() &&
+           cfgParam.P_CFG_VALUE_A.get() == cfgParam.P_CFG_VALUE_A.getDefault() &&
+           cfgParam.P_CFG_VALUE_B.get() == cfgParam.P_CFG_VALUE_B.getDefault() &&
+           cfgParam.P_CFG_TAIL.get() == cfgParam.P_CFG_TAIL.getDefault();
+}
+
+// emulate reset: rebuild everything from flash contents
+static void _reboot(ConfigParam& cfgParam)
+{
+    UserFlash::instance().reload();
+    cfgParam.initialize();
+}
+
+int main() {
+    auto& emuFlash = EmuFlashBackend::instance();
+    auto& userFlash = UserFlash::instance();
+    ConfigParam& cfgParam = ConfigParam::instance();
+    const size_t regionSize = userFlash.getRegionSize();
+    const uint32_t regionOfs = userFlash.getRegionOfs();
+    // enough commits to go around the ring (at most 3 records per sector)
+    const size_t numCommits = userFlash.getNumSectors() * 4;
+
+    printf("=== power fail test ===\r\n");
+    printf("RingSectors: %d\r\n", static_cast<int>(FLASH_PARAM_RING_SECTORS));
+    printf("Crc: %d\r\n", static_cast<int>(FLASH_PARAM_CRC));
+    emuFlash.blank();
+    _reboot(cfgParam);
+    uint32_t gen = 1;
+    _setGeneration(cfgParam, gen);
+    cfgParam.finalize();
+
+    size_t totalFailures = 0;
+    for (size_t commit = 0; commit < numCommits; commit++) {
+        const auto base = emuFlash.snapshot(regionOfs, regionSize);
+        // bytes erased and programmed by the commit from gen to gen + 1
+        emuFlash.resetCounters();
+        _setGeneration(cfgParam, gen + 1);
+        cfgParam.finalize();
+        const uint64_t eraseBytes = emuFlash.getEraseBytes();
+        const uint64_t programBytes = emuFlash.getProgramBytes();
+        const uint64_t commitBytes = eraseBytes + programBytes;
+
+        // cut power at every byte of the commit, then check the recovered image on reboot
+        size_t numOld = 0;
+        size_t numNew = 0;
+        size_t numFailures = 0;
+        for (uint64_t cut = 0; cut <= commitBytes; cut++) {
+            emuFlash.restore(regionOfs, base);
+            _reboot(cfgParam);
+            _setGeneration(cfgParam, gen + 1);
+            emuFlash.setPowerCut(cut);
+            cfgParam.finalize();
+            emuFlash.clearPowerCut();
+            _reboot(cfgParam);
+            if (_isGeneration(cfgParam, gen + 1)) {
+                numNew++;
+            } else if (_isGeneration(cfgParam, gen) && cut < commitBytes) {
+                numOld++;
+            } else {
+                if (numFailures == 0) {
+                    printf("failure at byte %lld of commit #%d (gen: %d)\r\n", static_cast<long long>(cut), static_cast<int>(commit), static_cast<int>(cfgParam.P_CFG_GEN.get()));
+                }
+                numFailures++;
+            }
+        }
+        printf("commit #%d: erase %lld B, program %lld B, old %d, new %d, failure %d\r\n",
+            static_cast<int>(commit), static_cast<long long>(eraseBytes), static_cast<long long>(programBytes),
+            static_cast<int>(numOld), static_cast<int>(numNew), static_cast<int>(numFailures));
+        totalFailures += numFailures;
+
+        // complete the commit to move on to the next slot
+        emuFlash.restore(regionOfs, base);
+        _reboot(cfgParam);
+        _setGeneration(cfgParam, gen + 1);
+        cfgParam.finalize();
+        gen++;
+
+        // program must only clear bits (1 to 0) without erase, including the commits cut by power loss
+        const uint32_t violations = emuFlash.getViolationCount();
+        if (violations > 0) {
+            printf("commit #%d: violation %d\r\n", static_cast<int>(commit), static_cast<int>(violations));
+            totalFailures += violations;
+        }
+    }
+
+    // bit rot: flip a bit at every byte of the region, then the recovered parameters must be
+    // the newest, an older generation (ring mode) or default values, but never be broken
+    if (FLASH_PARAM_CRC) {
+        const auto base = emuFlash.snapshot(regionOfs, regionSize);
+        size_t numNewest = 0;
+        size_t numOlder = 0;
+        size_t numDefault = 0;
+        size_t numFailures = 0;
+        for (size_t ofs = 0; ofs < regionSize; ofs++) {
+            auto contents = base;
+            contents.at(ofs) ^= 0x10;
+            emuFlash.restore(regionOfs, contents);
+            _reboot(cfgParam);
+            const uint32_t recovered = cfgParam.P_CFG_GEN.get();
+            if (recovered == gen && _isGeneration(cfgParam, gen)) {
+                numNewest++;
+            } else if (recovered < gen && _isGeneration(cfgParam, recovered)) {
+                numOlder++;
+            } else if (_isDefault(cfgParam)) {
+                numDefault++;
+            } else {
+                if (numFailures == 0) {
+                    printf("failure by bit flip at 0x%x (gen: %d)\r\n", static_cast<int>(ofs), static_cast<int>(recovered));
+                }
+                numFailures++;
+            }
+        }
+        printf("bit flip: newest %d, older %d, default %d, failure %d\r\n",
+            static_cast<int>(numNewest), static_cast<int>(numOlder), static_cast<int>(numDefault), static_cast<int>(numFailures));
+        totalFailures += numFailures;
+        emuFlash.restore(regionOfs, base);
+    }
+
+    // failure of safeExecute() (e.g. timeout to pause the other core) must leave flash unchanged and be counted
+    {
+        const auto base = emuFlash.snapshot(regionOfs, regionSize);
+        const uint32_t failures = cfgParam.getFlashStats().failures;
+        const uint32_t storeCount = cfgParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT);
+        _setGeneration(cfgParam, gen + 1);
+        emuFlash.setSafeExecuteFailure(true);
+        const bool result = cfgParam.finalize();
+        emuFlash.setSafeExecuteFailure(false);
+        const bool countKept = cfgParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT) == storeCount;
+        _reboot(cfgParam);
+        const bool ok = !result && countKept && cfgParam.getFlashStats().failures == failures + 1 &&
+                        emuFlash.snapshot(regionOfs, regionSize) == base && _isGeneration(cfgParam, gen);
+        printf("safeExecute failure: %s\r\n", ok ? "OK" : "NG");
+        if (!ok) { totalFailures++; }
+    }
+
+    // failure of the commit in background must not count up CFG_STORE_COUNT either
+    {
+        const auto base = emuFlash.snapshot(regionOfs, regionSize);
+        const uint32_t storeCount = cfgParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT);
+        FlashParamNs::AutoCommitConfig config;
+        config.async = true;
+        cfgParam.enableAutoCommit(config);
+        _setGeneration(cfgParam, gen + 1);
+        cfgParam.serviceAutoCommit(0);  // the change is seen at 0 ms
+        emuFlash.setSafeExecuteFailure(true);
+        const bool requested = cfgParam.serviceAutoCommit(config.quietMs);
+        cfgParam.serviceFinalize();
+        emuFlash.setSafeExecuteFailure(false);
+        const bool failed = cfgParam.getFinalizeResult() == FlashParamNs::COMMIT_FAILURE;
+        cfgParam.serviceAutoCommit(config.quietMs);  // settles the result
+        const bool countKept = cfgParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT) == storeCount &&
+                               cfgParam.getAutoCommitStats().failures == 1;
+        cfgParam.disableAutoCommit();
+        const bool unchanged = emuFlash.snapshot(regionOfs, regionSize) == base;
+        // the failure without auto commit is settled by the next request
+        emuFlash.setSafeExecuteFailure(true);
+        cfgParam.finalizeAsync();
+        cfgParam.serviceFinalize();
+        emuFlash.setSafeExecuteFailure(false);
+        const bool result = cfgParam.finalize();
+        const bool countedOnce = cfgParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT) == storeCount + 1;
+        _reboot(cfgParam);
+        const bool ok = requested && failed && countKept && unchanged && result && countedOnce &&
+                        cfgParam.getValue<uint32_t>(FlashParamNs::CFG_STORE_COUNT) == storeCount + 1 && _isGeneration(cfgParam, gen + 1);
+        printf("async commit failure: %s\r\n", ok ? "OK" : "NG");
+        if (!ok) { totalFailures++; }
+    }
+
+    printf("%s (failure %d)\r\n", (totalFailures == 0) ? "PASS" : "FAIL", static_cast<int>(totalFailures));
+    return (totalFailures == 0) ? 0 : 1;
+}
@@ -0,0 +1,74 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include <cstdio>
+
+#include "EmuFlashBackend.h"
+#include "ConfigParam.h"
+
+static void _printHelp()
+{
+    printf("h: print help\r\n");
+    printf("d: loadDefault\r\n");
+    printf("f: finalize (store to flash)\r\n");
+    printf("p: printInfo\r\n");
+    printf("e: print emulated flash info\r\n");
+    printf("x: export parameters as text\r\n");
+    printf("1: change values 1\r\n");
+    printf("2: change values 2\r\n");
+    printf("3: change values by name\r\n");
+}
+
+int main(int argc, char* argv[]) {
+    auto& emuFlash = FlashParamNs::EmuFlashBackend::instance();
+    // flash image file is kept over runs if designated
+    if (argc > 1 && !emuFlash.open(argv[1])) {
+        printf("failed to open %s\r\n", argv[1]);
+        return 1;
+    }
+
+    ConfigParam& cfgParam = ConfigParam::instance();
+
+    cfgParam.initialize();
+    cfgParam.printInfo();
+
+    // commands from stdin instead of serial terminal
+    int chr;
+    while ((chr = getchar()) != EOF) {
+        char c = static_cast<char>(chr);
+        if (c == 'h') {
+            _printHelp();
+        } else if (c == 'd') {
+            cfgParam.loadDefault();
+            printf("loadDefault\r\n");
+        } else if (c == 'f') {
+            if (cfgParam.finalize()) {
+                printf("success to store flash parameters\r\n");
+            } else {
+                printf("failure to store flash parameters\r\n");
+            }
+        } else if (c == 'p') {
+            cfgParam.printInfo();
+        } else if (c == 'e') {
+            emuFlash.printInfo();
+        } else if (c == 'x') {
+            cfgParam.exportTo(FlashParamNs::STREAM_TEXT, [](const uint8_t* data, const size_t& size, void*) {
+                return fwrite(data, 1, size, stdout) == size;
+            });
+        } else if (c == '1') {
+            cfgParam.P_CFG_INT8.set(-10);
+            cfgParam.P_CFG_STRING.set("abcdef0123456789ABCDEF");
+        } else if (c == '2') {
+            cfgParam.P_CFG_INT8.set(3);
+            cfgParam.P_CFG_STRING.set("0123456789");
+        } else if (c == '3') {
+            cfgParam.setValue<int8_t>("CFG_INT8", cfgParam.getValue<int8_t>("CFG_INT8") + 1);
+            cfgParam.setValue<double>("CFG_DOUBLE", 2.5e-3);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,56 @@
+/*-----------------------------------------------------------/
+/ ConfigParam.h
+/------------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/-----------------------------------------------------------*/
+
+#pragma once
+
+#include "FlashParam.h"
+
+typedef enum {
+    CFG_SHORT_NAME = FlashParamNs::CFG_ID_BASE,
+    CFG_TEXT,
+    CFG_NAME,
+    CFG_FLOAT,
+    CFG_DOUBLE,
+    CFG_UINT64,
+    CFG_INT64,
+    CFG_BOOL,
+    CFG_TABLE,
+    CFG_CALIB,
+} ValueParamId_t;
+
+//=================================
+// Interface of ValueParam class
+//=================================
+// parameters of each type whose values are checked over finalize() / initialize()
+struct ValueParam : FlashParamNs::FlashParam {
+    static ValueParam& instance()  // Singleton
+    {
+        static ValueParam instance;
+        return instance;
+    }
+    static constexpr uint32_t NumParams = CFG_CALIB - FlashParamNs::CFG_ID_BASE + 1;  // except for the built-in parameters
+    using ShortName_t = FlashParamNs::FixedString<10>;
+    using Name_t = FlashParamNs::FixedString<16>;
+    using Table_t = std::array<uint16_t, 4>;
+    struct Calib {
+        float gain;
+        int16_t offset;
+        uint8_t mode;
+    };
+    // Parameter<T>                      instance          id              name              default                size
+    FlashParamNs::Parameter<ShortName_t> P_CFG_SHORT_NAME {CFG_SHORT_NAME, "CFG_SHORT_NAME", "abcdefghij",          4};  // shorter than capacity on flash
+    FlashParamNs::Parameter<std::string> P_CFG_TEXT       {CFG_TEXT,       "CFG_TEXT",       "text",                16};
+    FlashParamNs::Parameter<Name_t>      P_CFG_NAME       {CFG_NAME,       "CFG_NAME",       "noname"};
+    FlashParamNs::Parameter<float>       P_CFG_FLOAT      {CFG_FLOAT,      "CFG_FLOAT",      1.0f};
+    FlashParamNs::Parameter<double>      P_CFG_DOUBLE     {CFG_DOUBLE,     "CFG_DOUBLE",     1.0};
+    FlashParamNs::Parameter<uint64_t>    P_CFG_UINT64     {CFG_UINT64,     "CFG_UINT64",     0};
+    FlashParamNs::Parameter<int64_t>     P_CFG_INT64      {CFG_INT64,      "CFG_INT64",      0};
+    FlashParamNs::Parameter<bool>        P_CFG_BOOL       {CFG_BOOL,       "CFG_BOOL",       false};
+    FlashParamNs::Parameter<Table_t>     P_CFG_TABLE      {CFG_TABLE,      "CFG_TABLE",      {1, 2, 3, 4}};
+    FlashParamNs::Parameter<Calib>       P_CFG_CALIB      {CFG_CALIB,      "CFG_CALIB",      {1.0f, 0, 0}};
+};
@@ -0,0 +1,174 @@
+/*------------------------------------------------------/
+/ Copyright (c) 2026, Elehobica
+/ Released under the BSD-2-Clause
+/ refer to https://opensource.org/licenses/BSD-2-Clause
+/------------------------------------------------------*/
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "ConfigParam.h"
+#include "EmuFlashBackend.h"
+
+using FlashParamNs::EmuFlashBackend;
+
+static bool _check(const char* name, bool result, size_t& failures)
+{
+    printf("%-48s %s\r\n", name, result ? "OK" : "NG");
+    if (!result) { failures++; }
+    return result;
+}
+
+// FixedString<N> stored with size < N: the value read from flash must not keep the characters beyond size
+static void _testShortString(ValueParam& valueParam, size_t& failures)
+{
+    valueParam.P_CFG_SHORT_NAME.set("wxyz");
+    valueParam.finalize();
+    valueParam.initialize();
+    _check("short string: value of size", valueParam.P_CFG_SHORT_NAME.get() == "wxyz", failures);
+    valueParam.P_CFG_SHORT_NAME.set("0123456789");  // full length, truncated to size on flash
+    valueParam.finalize();
+    valueParam.initialize();
+    _check("short string: full length truncated", valueParam.P_CFG_SHORT_NAME.get() == "0123", failures);
+    _check("short string: getFromFlash()", valueParam.P_CFG_SHORT_NAME.getFromFlash() == "0123", failures);
+}
+
+// memory sink / source of exportTo() / importFrom()
+struct Buffer {
+    std::vector<uint8_t> data;
+    size_t pos = 0;
+};
+
+static bool _sink(const uint8_t* data, const size_t& size, void* context)
+{
+    auto& buf = *static_cast<Buffer*>(context);
+    buf.data.insert(buf.data.end(), data, data + size);
+    return true;
+}
+
+static size_t _source(uint8_t* data, const size_t& size, void* context)
+{
+    auto& buf = *static_cast<Buffer*>(context);
+    const size_t n = std::min(size, buf.data.size() - buf.pos);
+    std::copy_n(buf.data.begin() + buf.pos, n, data);
+    buf.pos += n;
+    return n;
+}
+
+static FlashParamNs::ImportResult _importText(ValueParam& valueParam, const char* text)
+{
+    Buffer buffer;
+    buffer.data.assign(text, text + std::strlen(text));
+    return valueParam.importFrom(FlashParamNs::STREAM_TEXT, _source, &buffer);
+}
+
+static void _setValues(ValueParam& valueParam)
+{
+    valueParam.P_CFG_TEXT.set("hello\tworld");
+    valueParam.P_CFG_NAME.set("name with space");
+    valueParam.P_CFG_FLOAT.set(0.1f);
+    valueParam.P_CFG_DOUBLE.set(-1.056e-8);
+    valueParam.P_CFG_UINT64.set(0xfedcba9876543210ULL);
+    valueParam.P_CFG_INT64.set(-(1LL << 62));
+    valueParam.P_CFG_BOOL.set(true);
+    valueParam.P_CFG_TABLE.set({0x0102, 0xfffe, 0, 0x8000});
+    valueParam.P_CFG_CALIB.set({0.75f, -12, 3});
+}
+
+static bool _hasValues(ValueParam& valueParam)
+{
+    const auto& calib = valueParam.P_CFG_CALIB.get();
+    return valueParam.P_CFG_TEXT.get() == "hello\tworld" && valueParam.P_CFG_NAME.get() == "name with space" &&
+        valueParam.P_CFG_FLOAT.get() == 0.1f && valueParam.P_CFG_DOUBLE.get() == -1.056e-8 &&
+        valueParam.P_CFG_UINT64.get() == 0xfedcba9876543210ULL && valueParam.P_CFG_INT64.get() == -(1LL << 62) &&
+        valueParam.P_CFG_BOOL.get() && valueParam.P_CFG_TABLE.get() == ValueParam::Table_t{0x0102, 0xfffe, 0, 0x8000} &&
+        calib.gain == 0.75f && calib.offset == -12 && calib.mode == 3;
+}
+
+// exportTo() / importFrom() restore the values of each type, and the text is validated per line
+static void _testStream(ValueParam& valueParam, size_t& failures)
+{
+    for (const auto& [format, label] : {std::make_pair(FlashParamNs::STREAM_BINARY, "binary"), std::make_pair(FlashParamNs::STREAM_TEXT, "text")}) {
+        char name[64];
+        _setValues(valueParam);
+        Buffer exported;
+        valueParam.exportTo(format, _sink, &exported);
+        valueParam.loadDefault(true);
+        const auto result = valueParam.importFrom(format, _source, &exported);
+        snprintf(name, sizeof(name), "stream %s: all applied", label);
+        _check(name, result.complete && result.applied == ValueParam::NumParams && result.rejected == 0, failures);
+        snprintf(name, sizeof(name), "stream %s: values restored", label);
+        _check(name, _hasValues(valueParam), failures);
+        Buffer reexported;
+        valueParam.exportTo(format, _sink, &reexported);
+        snprintf(name, sizeof(name), "stream %s: round trip", label);
+        _check(name, reexported.data == exported.data, failures);
+    }
+    char text[160];
+    // a truncated line is rejected, and the next line is still applied
+    snprintf(text, sizeof(text), "%d CFG_INT64 i64 8\n%d CFG_INT64 i64 8 -5\n", CFG_INT64, CFG_INT64);
+    auto result = _importText(valueParam, text);
+    _check("text: next line of truncated line", result.applied == 1 && result.rejected == 1 && valueParam.P_CFG_INT64.get() == -5, failures);
+    // integers are decimal, and out of range of the type is rejected
+    snprintf(text, sizeof(text), "%d CFG_INT64 i64 8 010\n", CFG_INT64);
+    result = _importText(valueParam, text);
+    _check("text: leading zero is decimal", result.applied == 1 && valueParam.P_CFG_INT64.get() == 10, failures);
+    snprintf(text, sizeof(text), "%d CFG_INT64 i64 8 9223372036854775808\n%d CFG_UINT64 u64 8 18446744073709551616\n", CFG_INT64, CFG_UINT64);
+    result = _importText(valueParam, text);
+    _check("text: out of range of 64 bit rejected", result.applied == 0 && result.rejected == 2 && valueParam.P_CFG_INT64.get() == 10, failures);
+    // the shorter string doesn't keep the characters of the previous value
+    valueParam.P_CFG_SHORT_NAME.set("0123456789");
+    snprintf(text, sizeof(text), "%d CFG_SHORT_NAME str 4 wxyz\n", CFG_SHORT_NAME);
+    result = _importText(valueParam, text);
+    _check("text: short string imported", result.applied == 1 && valueParam.P_CFG_SHORT_NAME.get() == "wxyz", failures);
+}
+
+// set(i, element) / set(&S::member, value) mark only the changed element dirty, and values survive finalize() / initialize()
+static void _testAggregate(ValueParam& valueParam, size_t& failures)
+{
+    auto& table = valueParam.P_CFG_TABLE;
+    auto& calib = valueParam.P_CFG_CALIB;
+    valueParam.finalize();
+    valueParam.initialize();
+    _check("aggregate: clean after initialize()", !table.isDirty() && !calib.isDirty(), failures);
+    int notified = 0;
+    FlashParamNs::ChangeObserver observer{[](const uint32_t&, void* context) { (*static_cast<int*>(context))++; }, &notified};
+    table.subscribe(observer);
+    table.set(2, table.get(2));
+    _check("aggregate: set() without change", !table.isDirty() && notified == 0, failures);
+    table.set(2, 0x1234);
+    table.unsubscribe(observer);
+    _check("aggregate: set(i) marks only element i",
+        table.isDirty() && table.isDirty(2) && !table.isDirty(0) && !table.isDirty(1) && !table.isDirty(3) && notified == 1, failures);
+    calib.set(&ValueParam::Calib::offset, static_cast<int16_t>(-345));
+    calib.set(&ValueParam::Calib::mode, static_cast<uint8_t>(7));
+    _check("aggregate: set(&member) marks the struct", calib.isDirty() && calib.isDirty(0), failures);
+    valueParam.finalize();
+    _check("aggregate: clean after finalize()", !table.isDirty() && !calib.isDirty(), failures);
+    const auto stored = table.get();
+    const auto gain = calib.get().gain;
+    valueParam.initialize();
+    _check("aggregate: array restored", table.get() == stored && table.get(2) == 0x1234 && table.getFromFlash() == stored, failures);
+    _check("aggregate: struct members restored",
+        calib.get().gain == gain && calib.get().offset == -345 && calib.get().mode == 7 && calib.getFromFlash().offset == -345, failures);
+}
+
+int main() {
+    auto& emuFlash = EmuFlashBackend::instance();
+    emuFlash.blank();
+    ValueParam& valueParam = ValueParam::instance();
+    valueParam.initialize();
+
+    printf("=== value test ===\r\n");
+    size_t failures = 0;
+
+    _testShortString(valueParam, failures);
+    _testStream(valueParam, failures);
+    _testAggregate(valueParam, failures);
+
+    printf("%s (failure %d)\r\n", (failures == 0) ? "PASS" : "FAIL", static_cast<int>(failures));
+    return (failures == 0) ? 0 : 1;
+}
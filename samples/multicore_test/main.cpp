@@ -22,9 +22,27 @@ static void _core1_process()
     // without this, finalize() fails
     flash_safe_execute_core_init();
 
+    ConfigParam& cfgParam = ConfigParam::instance();
+    uint32_t count = 0;
     while (true) {
-        printf(".");
-        sleep_ms(1000);
+        // commit requested by finalizeAsync() on core0
+        cfgParam.serviceFinalize();
+        if (++count % 100 == 0) {
+            printf(".");
+        }
+        sleep_ms(10);
+    }
+}
+
+static void _finalize_callback(FlashParamNs::CommitResult_t result, void* context)
+{
+    // called on core1
+    if (result == FlashParamNs::COMMIT_SUCCESS) {
+        printf("success to store flash parameters (async)\r\n");
+    } else if (result == FlashParamNs::COMMIT_FAILURE) {
+        printf("failure to store flash parameters (async)\r\n");
+    } else {
+        printf("superseded by newer request (async)\r\n");
     }
 }
 
@@ -33,6 +51,7 @@ static void _printHelp()
     printf("h: print help\r\n");
     printf("d: loadDefault\r\n");
     printf("f: finalize (store to flash)\r\n");
+    printf("a: finalizeAsync (store to flash on core1)\r\n");
     printf("p: printInfo\r\n");
     printf("1: change values 1\r\n");
     printf("2: change values 2\r\n");
@@ -52,6 +71,8 @@ int main() {
     cfgParam.initialize();
     cfgParam.printInfo();
 
+    // core0 can also be locked out while core1 stores to flash
+    flash_safe_execute_core_init();
     // start core1
     multicore_launch_core1(_core1_process);
 
@@ -70,6 +91,9 @@ int main() {
                 } else {
                     printf("failure to store flash parameters\r\n");
                 }
+            } else if (c == 'a') {
+                cfgParam.finalizeAsync(_finalize_callback);
+                printf("finalizeAsync requested\r\n");
             } else if (c == 'p') {
                 cfgParam.printInfo();
             } else if (c == '1') {
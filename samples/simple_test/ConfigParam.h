@@ -23,6 +23,7 @@ typedef enum {
     CFG_INT64,
     CFG_FLOAT,
     CFG_DOUBLE,
+    CFG_ID_LAST = CFG_DOUBLE,  // to be updated when a parameter is added
 } ParamId_t;
 
 //=================================
@@ -34,6 +35,14 @@ struct ConfigParam : FlashParamNs::FlashParam {
         static ConfigParam instance;
         return instance;
     }
+    // name index for getValue<T>(name) / setValue<T>(name, value)
+    static constexpr FlashParamNs::NameIndex Names{{
+        {"CFG_STRING", CFG_STRING}, {"CFG_BOOL", CFG_BOOL},
+        {"CFG_UINT8", CFG_UINT8}, {"CFG_UINT16", CFG_UINT16}, {"CFG_UINT32", CFG_UINT32}, {"CFG_UINT64", CFG_UINT64},
+        {"CFG_INT8", CFG_INT8}, {"CFG_INT16", CFG_INT16}, {"CFG_INT32", CFG_INT32}, {"CFG_INT64", CFG_INT64},
+        {"CFG_FLOAT", CFG_FLOAT}, {"CFG_DOUBLE", CFG_DOUBLE},
+    }};
+    ConfigParam() { setNameIndex(Names); }
     // Parameter<T>                      instance         id               name             default    size
     FlashParamNs::Parameter<std::string> P_CFG_STRING    {CFG_STRING,     "CFG_STRING",     "abcdefg", 16};
     FlashParamNs::Parameter<bool>        P_CFG_BOOL      {CFG_BOOL,       "CFG_BOOL",       false};
@@ -48,3 +57,5 @@ struct ConfigParam : FlashParamNs::FlashParam {
     FlashParamNs::Parameter<float>       P_CFG_FLOAT     {CFG_FLOAT,      "CFG_FLOAT",      3.326f};
     FlashParamNs::Parameter<double>      P_CFG_DOUBLE    {CFG_DOUBLE,     "CFG_DOUBLE",     -1.056e-8};
 };
+// the index has all the ids of the parameters, and the name of each id is checked by setNameIndex()
+static_assert(ConfigParam::Names.coversIds(FlashParamNs::CFG_ID_BASE, CFG_ID_LAST), "Names doesn't match the parameters");
@@ -20,7 +20,8 @@ struct ConfigParam : FlashParamNs::FlashParam {
         return instance;
     }
     static constexpr uint32_t ID_BASE = FlashParamNs::CFG_ID_BASE;
-    // Parameter<T>                      instance        id           name             default size
-    FlashParamNs::Parameter<std::string> P_CFG_WIFI_SSID{ID_BASE + 0, "CFG_WIFI_SSID", "",     16};
-    FlashParamNs::Parameter<std::string> P_CFG_WIFI_PASS{ID_BASE + 1, "CFG_WIFI_PASS", "",     16};
+    // FixedString<N> doesn't use heap and keeps the same flash format as std::string with size N
+    // Parameter<T>                                       instance        id           name             default
+    FlashParamNs::Parameter<FlashParamNs::FixedString<16>> P_CFG_WIFI_SSID{ID_BASE + 0, "CFG_WIFI_SSID", ""};
+    FlashParamNs::Parameter<FlashParamNs::FixedString<16>> P_CFG_WIFI_PASS{ID_BASE + 1, "CFG_WIFI_PASS", ""};
 };
@@ -58,13 +58,13 @@ static bool _check_pico_w()
     }
 }
 
-static bool _connect_wifi(const std::string& ssid, const std::string& password, const int retry = 3)
+static bool _connect_wifi(const char* ssid, const char* password, const int retry = 3)
 {
     printf("... connecting Wi-Fi\r\n");
 
     cyw43_arch_enable_sta_mode();
     for (int i = 0; i < retry; i++) {
-        if (cyw43_arch_wifi_connect_timeout_ms(ssid.c_str(), password.c_str(), CYW43_AUTH_WPA2_AES_PSK, 10000)) {
+        if (cyw43_arch_wifi_connect_timeout_ms(ssid, password, CYW43_AUTH_WPA2_AES_PSK, 10000)) {
             printf("failed to connect: %d\r\n", i);
             if (i < retry - 1) {
                 continue;
@@ -117,7 +117,7 @@ int main() {
 
         if (ssid.length() > 0 && pass.length() > 0) {
             _set_led(true);
-            if (_connect_wifi(ssid, pass)) {
+            if (_connect_wifi(ssid.c_str(), pass.c_str())) {
                 printf("SUCCESS: connected to %s\r\n", ssid.c_str());
             } else {
                 printf("ERROR: failed Wi-Fi connection: %s\r\n", ssid.c_str());
@@ -150,11 +150,11 @@ int main() {
                 std::string ssid, pass;
                 if (config_wifi(ssid, pass)) {
                     // trial to connect Wi-Fi
-                    if (_connect_wifi(ssid, pass)) {
+                    if (_connect_wifi(ssid.c_str(), pass.c_str())) {
                         printf("SUCCESS: connected to %s\r\n", ssid.c_str());
                         // store to flash
-                        cfgParam.P_CFG_WIFI_SSID.set(ssid);
-                        cfgParam.P_CFG_WIFI_PASS.set(pass);
+                        cfgParam.P_CFG_WIFI_SSID.set(ssid.c_str());
+                        cfgParam.P_CFG_WIFI_PASS.set(pass.c_str());
                         if (cfgParam.finalize()) {
                             printf("Wi-Fi configuration stored to flash\r\n");
                         } else {